@@ -0,0 +1,127 @@
+#include "ComputeFractals.h"
+
+#include "AssetPath.h"
+
+#include <cmath>
+#include <stdexcept>
+
+
+bool computeBackendAvailable()
+{
+#ifdef GL_VERSION_4_3
+	return GLAD_GL_VERSION_4_3 != 0; // set by gladLoadGL for a 4.3+ context
+#else
+	return false;
+#endif
+}
+
+#ifdef GL_VERSION_4_3
+
+namespace
+{
+	// one primitive is two vec4s in the storage buffer (see fractal.comp)
+	const GLsizeiptr primitiveBytes = 2 * 4 * sizeof(float);
+}
+
+
+ComputeFractals::ComputeFractals()
+	: generator(AssetPath::Instance()->Get("shaders/fractal.comp"))
+	, puller(
+		AssetPath::Instance()->Get("shaders/pull.vert"),
+		AssetPath::Instance()->Get("shaders/basic.frag"))
+	, fractal(0)
+	, drawFirst(0)
+	, drawCount(0)
+{}
+
+
+void ComputeFractals::generate(int fractal_, int depth, const TreeParams &params)
+{
+	fractal = fractal_;
+	const GLuint arity = (fractal == 1) ? 2 : 3;
+
+	// where every level starts, the root is level 0
+	std::vector<GLuint> levelFirst(depth + 2, 0);
+	GLuint levelSize = 1;
+	for (int level = 0; level <= depth; level++)
+	{
+		levelFirst[level + 1] = levelFirst[level] + levelSize;
+		levelSize *= arity;
+	}
+	primitives.reserve(levelFirst[depth + 1] * primitiveBytes, GL_DYNAMIC_COPY);
+
+	// the root primitive, the same starting point as the CPU generators
+	float root[8] = {0.f};
+	switch (fractal)
+	{
+	case 0: // corners
+		root[0] = -0.5f, root[1] = -0.5f, root[2] = 0.5f, root[3] = -0.5f, root[4] = 0.f, root[5] = 0.5f;
+		break;
+	case 1: // ends and their t
+		root[0] = -0.5f, root[1] = 0.f, root[2] = 0.5f, root[3] = 0.f, root[4] = 0.f, root[5] = 1.f;
+		break;
+	default: // trunk and its depth
+		root[0] = 0.f, root[1] = -0.8f, root[2] = 0.f, root[3] = -0.3f, root[4] = 0.f;
+		break;
+	}
+	primitives.uploadData(0, primitiveBytes, root);
+	primitives.bindBase(0);
+
+	const float angle = glm::radians(params.angle);
+	generator.use();
+	glUniform1i(glGetUniformLocation(generator, "fractal"), fractal);
+	glUniform1f(glGetUniformLocation(generator, "cosA"), std::cos(angle));
+	glUniform1f(glGetUniformLocation(generator, "sinA"), std::sin(angle));
+	glUniform1f(glGetUniformLocation(generator, "scale"), params.scale);
+	glUniform1f(glGetUniformLocation(generator, "branchPoint"), params.branchPoint);
+	for (int level = 0; level < depth; level++)
+	{ // one dispatch per level over its whole frontier, writing the next level
+		const GLuint count = levelFirst[level + 1] - levelFirst[level];
+		glUniform1ui(glGetUniformLocation(generator, "first"), levelFirst[level]);
+		glUniform1ui(glGetUniformLocation(generator, "count"), count);
+		glUniform1ui(glGetUniformLocation(generator, "childFirst"), levelFirst[level + 1]);
+		generator.dispatch((count + 63) / 64);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT); // the next level reads what this one wrote
+	}
+
+	// the Sierpinski triangle and Levy curve only draw the deepest level, the tree draws every level
+	if (fractal == 2)
+	{
+		drawFirst = 0;
+		drawCount = static_cast<GLsizei>(2 * levelFirst[depth + 1]);
+	}
+	else
+	{
+		drawFirst = levelFirst[depth];
+		drawCount = static_cast<GLsizei>((levelFirst[depth + 1] - levelFirst[depth]) * (fractal == 0 ? 3 : 2));
+	}
+}
+
+
+void ComputeFractals::draw(GLenum mode)
+{
+	puller.use();
+	emptyVao.bind();
+	primitives.bindBase(0);
+	glUniform1i(glGetUniformLocation(puller, "fractal"), fractal);
+	glUniform1ui(glGetUniformLocation(puller, "first"), drawFirst);
+	glDrawArrays(mode, 0, drawCount);
+}
+
+#else
+
+ComputeFractals::ComputeFractals()
+	: fractal(0)
+	, drawFirst(0)
+	, drawCount(0)
+{
+	throw std::runtime_error("The compute backend needs the OpenGL 4.6 loader (FRACTAL_GL46)");
+}
+
+void ComputeFractals::generate(int, int, const TreeParams &)
+{}
+
+void ComputeFractals::draw(GLenum)
+{}
+
+#endif
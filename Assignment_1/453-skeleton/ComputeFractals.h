@@ -0,0 +1,51 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// Opt-in GL 4.3+ backend that generates the fractals with a compute shader.
+// All levels of the recursion live one after the other in a single storage
+// buffer, and generating a level is one dispatch over the level before it (the
+// frontier), every invocation writing the children of one primitive. Drawing
+// pulls the vertices straight out of that buffer by gl_VertexID, there are no
+// vertex buffers.
+//
+// Needs the 4.6 loader (configure with -DFRACTAL_GL46=ON) and a 4.3 context.
+// Without either, computeBackendAvailable() is false and the CPU path is used
+// (the class still compiles against the 3.3 loader, but can't be constructed).
+//------------------------------------------------------------------------------
+
+#include "ComputeProgram.h"
+#include "Fractals.h"
+#include "ShaderProgram.h"
+#include "ShaderStorageBuffer.h"
+#include "VertexArray.h"
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// Whether this build and the current context can run ComputeFractals
+bool computeBackendAvailable();
+
+class ComputeFractals {
+public:
+	// Only construct it when computeBackendAvailable(), otherwise the shaders throw std::runtime_error
+	ComputeFractals();
+
+	// fractal is 0 for the Sierpinski triangle, 1 the Levy curve and 2 the tree (the FractalTypes order)
+	void generate(int fractal, int depth, const TreeParams &params);
+	void draw(GLenum mode);
+
+	GLsizei vertexCount() const { return drawCount; }
+
+private:
+#ifdef GL_VERSION_4_3
+	ComputeProgram generator;
+	ShaderProgram puller;
+	ShaderStorageBuffer primitives; // two vec4s per primitive, level after level
+	VertexArray emptyVao;			// core profile still wants one bound for drawing
+#endif
+
+	int fractal;
+	GLuint drawFirst; // first primitive drawn (the deepest level, or the root for the tree)
+	GLsizei drawCount;
+};
@@ -0,0 +1,49 @@
+#include "ComputeProgram.h"
+
+#include "Log.h"
+
+#include <stdexcept>
+#include <vector>
+
+#ifdef GL_VERSION_4_3
+
+ComputeProgram::ComputeProgram(const std::string& computePath)
+	: programID()
+	, compute(computePath, GL_COMPUTE_SHADER)
+{
+	attach(*this, compute);
+	glLinkProgram(programID);
+
+	if (!checkAndLogLinkSuccess()) {
+		glDeleteProgram(programID);
+		throw std::runtime_error("Compute shader did not link.");
+	}
+}
+
+
+void attach(ComputeProgram& cp, Shader& s) {
+	glAttachShader(cp.programID, s.shaderID);
+}
+
+
+bool ComputeProgram::checkAndLogLinkSuccess() const {
+
+	GLint success;
+
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success) {
+		GLint logLength;
+		glGetProgramiv(programID, GL_INFO_LOG_LENGTH, &logLength);
+		std::vector<char> log(logLength);
+		glGetProgramInfoLog(programID, logLength, NULL, log.data());
+
+		Log::error("COMPUTE_PROGRAM linking {}:\n{}", compute.getPath(), log.data());
+		return false;
+	}
+	else {
+		Log::info("COMPUTE_PROGRAM successfully compiled and linked {}", compute.getPath());
+		return true;
+	}
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// A ShaderProgram made of a single compute shader. Needs the 4.6 loader
+// (FRACTAL_GL46 in CMake) and a GL 4.3 context, so it only exists in builds
+// where the loader provides GL_VERSION_4_3.
+//------------------------------------------------------------------------------
+
+#include "Shader.h"
+
+#include "GLHandles.h"
+#include "GLState.h"
+
+#include <glad/glad.h>
+
+#include <string>
+
+#ifdef GL_VERSION_4_3
+
+class ComputeProgram {
+
+public:
+	ComputeProgram(const std::string& computePath);
+	// Rule of zero, like ShaderProgram
+
+	// Public interface
+	void use() const { GLState::useProgram(programID); }
+	// Runs groups work groups along x (each as large as the shader's local_size_x)
+	void dispatch(GLuint groups) const { glDispatchCompute(groups, 1, 1); }
+
+	void friend attach(ComputeProgram& cp, Shader& s);
+
+	operator GLuint() const {
+		return programID;
+	}
+
+private:
+	ShaderProgramHandle programID;
+
+	Shader compute;
+
+	bool checkAndLogLinkSuccess() const;
+};
+
+#endif
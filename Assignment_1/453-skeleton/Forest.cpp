@@ -0,0 +1,149 @@
+#include "Forest.h"
+
+#include "Fractals.h"
+#include "Geometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+Forest::Forest(int maxDepth)
+	: vao()
+	, vertBuffer(0, 3, GL_FLOAT)
+	, colorsBuffer(1, 3, GL_FLOAT)
+	, transformBuffer(2, 3, GL_FLOAT, 1)
+	, tintBuffer(3, 3, GL_FLOAT, 1)
+	, boundsMin(0.f)
+	, boundsMax(0.f)
+	, fieldSize(0.f)
+	, batchStart(maxDepth + 1, 0)
+	, batchSize(maxDepth + 1, 0)
+{
+	// generate the tree once for every depth and pack them all into one buffer
+	CPU_Geometry all;
+	CPU_Geometry tree;
+	for (int depth = 0; depth <= maxDepth; depth++)
+	{
+		generateTree(tree, depth);
+		meshFirst.push_back(static_cast<GLint>(all.verts.size()));
+		meshCount.push_back(static_cast<GLsizei>(tree.verts.size()));
+		all.verts.insert(all.verts.end(), tree.verts.begin(), tree.verts.end());
+		all.cols.insert(all.cols.end(), tree.cols.begin(), tree.cols.end());
+	}
+
+	// the deepest tree reaches furthest, so its box holds every depth
+	boundsMin = glm::vec2(tree.verts.front());
+	boundsMax = boundsMin;
+	for (const glm::vec3 &v : tree.verts)
+	{
+		boundsMin = glm::min(boundsMin, glm::vec2(v));
+		boundsMax = glm::max(boundsMax, glm::vec2(v));
+	}
+
+	vertBuffer.uploadData(sizeof(glm::vec3) * all.verts.size(), all.verts.data(), GL_STATIC_DRAW);
+	colorsBuffer.uploadData(sizeof(glm::vec3) * all.cols.size(), all.cols.data(), GL_STATIC_DRAW);
+}
+
+
+void Forest::scatter(int count, unsigned int seed)
+{
+	std::mt19937 rng(seed); // fixed seed so the same forest comes back every run
+	fieldSize = 0.25f * std::sqrt(static_cast<float>(count));
+	std::uniform_real_distribution<float> position(-0.5f * fieldSize, 0.5f * fieldSize);
+	std::uniform_real_distribution<float> scale(0.15f, 0.35f);
+	std::uniform_real_distribution<float> tint(0.7f, 1.15f);
+
+	instances.resize(count);
+	for (Instance &tree : instances)
+	{
+		tree.position = glm::vec2(position(rng), position(rng));
+		tree.scale = scale(rng);
+		tree.tint = glm::vec3(tint(rng), tint(rng), tint(rng));
+	}
+}
+
+
+void Forest::update(const ForestCamera &camera, glm::ivec2 viewport, int depthLimit, float lodPixels)
+{
+	const int maxDepth = static_cast<int>(meshFirst.size()) - 1;
+	depthLimit = std::clamp(depthLimit, 0, maxDepth);
+
+	// the trunk is 0.5 long and every level halves the branches, so the finest branch at
+	// depth d is 0.5 * 0.5^d in tree space. NDC spans 2 units across the smaller window side
+	const float pixelsPerUnit = camera.zoom * 0.5f * static_cast<float>(std::max(1, std::min(viewport.x, viewport.y)));
+
+	// first pass: cull and pick a depth, counting how many trees land in each batch
+	std::fill(batchSize.begin(), batchSize.end(), 0);
+	instanceDepth.resize(instances.size());
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		const Instance &tree = instances[i];
+		glm::vec2 lo = (tree.position + boundsMin * tree.scale - camera.position) * camera.zoom;
+		glm::vec2 hi = (tree.position + boundsMax * tree.scale - camera.position) * camera.zoom;
+		if (hi.x < -1.f || lo.x > 1.f || hi.y < -1.f || lo.y > 1.f)
+		{
+			instanceDepth[i] = -1; // off screen, never uploaded
+			continue;
+		}
+
+		float trunkPixels = 0.5f * tree.scale * pixelsPerUnit;
+		int depth = static_cast<int>(std::ceil(std::log2(std::max(trunkPixels / lodPixels, 1.f))));
+		depth = std::min(depth, depthLimit);
+		instanceDepth[i] = depth;
+		batchSize[depth]++;
+	}
+
+	// second pass: counting sort the visible trees into one run per depth
+	int total = 0;
+	for (int depth = 0; depth <= maxDepth; depth++)
+	{
+		batchStart[depth] = total;
+		total += batchSize[depth];
+	}
+	visibleTransforms.resize(total);
+	visibleTints.resize(total);
+
+	std::vector<int> cursor = batchStart;
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		if (instanceDepth[i] < 0)
+		{
+			continue;
+		}
+		int slot = cursor[instanceDepth[i]]++;
+		visibleTransforms[slot] = glm::vec3(instances[i].position, instances[i].scale);
+		visibleTints[slot] = instances[i].tint;
+	}
+
+	transformBuffer.uploadData(sizeof(glm::vec3) * visibleTransforms.size(), visibleTransforms.data(), GL_STREAM_DRAW);
+	tintBuffer.uploadData(sizeof(glm::vec3) * visibleTints.size(), visibleTints.data(), GL_STREAM_DRAW);
+}
+
+
+void Forest::draw()
+{
+	vao.bind();
+	for (size_t depth = 0; depth < meshFirst.size(); depth++)
+	{
+		if (batchSize[depth] == 0)
+		{
+			continue;
+		}
+		// point the per-instance attributes at this depth's run
+		transformBuffer.setOffset(sizeof(glm::vec3) * batchStart[depth]);
+		tintBuffer.setOffset(sizeof(glm::vec3) * batchStart[depth]);
+		glDrawArraysInstanced(GL_LINES, meshFirst[depth], meshCount[depth], batchSize[depth]);
+	}
+}
+
+
+long long Forest::submittedVertices() const
+{
+	long long total = 0;
+	for (size_t depth = 0; depth < meshCount.size(); depth++)
+	{
+		total += static_cast<long long>(meshCount[depth]) * batchSize[depth];
+	}
+	return total;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// A field of fractal trees drawn with instancing. The tree is generated once
+// per depth, every tree in the field is an instance of one of those meshes, and
+// each frame the visible trees are sorted into one instanced draw per depth.
+//------------------------------------------------------------------------------
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// A very small 2D camera (pan + zoom), which is all the forest needs
+struct ForestCamera {
+	glm::vec2 position = glm::vec2(0.f);
+	float zoom = 1.f;
+};
+
+
+class Forest {
+public:
+	Forest(int maxDepth);
+
+	// Randomly places count trees, the area grows with count so density stays the same
+	void scatter(int count, unsigned int seed = 453);
+
+	// Culls trees outside the view, picks a depth for each visible tree from its size
+	// on screen (finest branch around lodPixels long, capped at depthLimit) and uploads
+	// the per-instance data sorted by depth
+	void update(const ForestCamera &camera, glm::ivec2 viewport, int depthLimit, float lodPixels);
+	void draw();
+
+	int treeCount() const { return static_cast<int>(instances.size()); }
+	int visibleCount() const { return static_cast<int>(visibleTransforms.size()); }
+	float extent() const { return fieldSize; }
+	const std::vector<int> &batchSizes() const { return batchSize; } // visible trees per depth
+	long long submittedVertices() const;
+
+private:
+	struct Instance {
+		glm::vec2 position;
+		float scale;
+		glm::vec3 tint;
+	};
+
+	// note: due to how OpenGL works, vao needs to be
+	// defined and initialized before the vertex buffers
+	VertexArray vao;
+
+	VertexBuffer vertBuffer;
+	VertexBuffer colorsBuffer;
+	VertexBuffer transformBuffer; // per instance: xy is the offset, z the scale
+	VertexBuffer tintBuffer;	  // per instance colour, multiplied with the tree colour
+
+	// all depths live back to back in vertBuffer/colorsBuffer
+	std::vector<GLint> meshFirst;
+	std::vector<GLsizei> meshCount;
+	glm::vec2 boundsMin; // bounding box of the deepest tree in tree space, used for culling
+	glm::vec2 boundsMax;
+
+	std::vector<Instance> instances;
+	float fieldSize;
+
+	// rebuilt by update(), one contiguous run per depth
+	std::vector<int> instanceDepth;
+	std::vector<glm::vec3> visibleTransforms;
+	std::vector<glm::vec3> visibleTints;
+	std::vector<int> batchStart;
+	std::vector<int> batchSize;
+};
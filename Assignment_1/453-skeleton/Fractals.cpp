@@ -0,0 +1,325 @@
+#include "Fractals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional> // added this for std::function
+
+// Sizes the CPU geometry for exactly count vertices (keeping the old allocations where it can)
+// and points a GeometryOutput at it
+static GeometryOutput prepareOutput(CPU_Geometry &cpuGeom, size_t count, bool withAncestors)
+{
+	cpuGeom.verts.resize(count);
+	cpuGeom.cols.resize(count);
+	cpuGeom.ancestors.resize(withAncestors ? count : 0);
+	return {cpuGeom.verts.data(), cpuGeom.cols.data(), withAncestors ? cpuGeom.ancestors.data() : nullptr};
+}
+
+static size_t powerOf(size_t base, int exponent)
+{
+	size_t result = 1;
+	for (int i = 0; i < exponent; i++)
+	{
+		result *= base;
+	}
+	return result;
+}
+
+size_t sierpinskiVertexCount(int depth)
+{ // 3^depth triangles
+	return 3 * powerOf(3, depth);
+}
+
+size_t levyVertexCount(int depth)
+{ // 2^depth segments
+	return 2 * powerOf(2, depth);
+}
+
+size_t treeVertexCount(int depth)
+{ // every branch has three children, so there are 1 + 3 + ... + 3^depth = (3^(depth+1) - 1) / 2 branches
+	return powerOf(3, depth + 1) - 1;
+}
+
+float levyLatticeStep(int depth)
+{ // the root segment's ends are at +-1/2
+	return std::ldexp(1.0f, -std::max(1, (depth + 1) / 2));
+}
+
+// --- Three Fractal Generating Functions ---
+void generateSierpinskiTriangle(CPU_Geometry &cpuGeom, int depth, bool withAncestors)
+{
+	generateSierpinskiTriangle(prepareOutput(cpuGeom, sierpinskiVertexCount(depth), withAncestors), depth);
+}
+
+void generateSierpinskiTriangle(const GeometryOutput &out, int depth)
+{
+	size_t next = 0; // the next vertex to write, the output was sized for exactly this fractal
+
+	// recursively generate a Sierpinski using a lambda function
+	// I prefer lambda function because it has access to the outer scope, and it is a cleaner way to write recursive functions
+	// a1, a2 and a3 are the corners of the triangle one depth up, where each vertex morphs from
+	std::function<void(glm::vec3, glm::vec3, glm::vec3, int, glm::vec3, glm::vec3, glm::vec3)> generate =
+		[&](glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, int depth, glm::vec3 a1, glm::vec3 a2, glm::vec3 a3)
+	{
+		if (depth == 0) // Base case: Depth is zero, draw a triangle
+		{
+			out.verts[next] = p1;
+			out.verts[next + 1] = p2;
+			out.verts[next + 2] = p3; // write all three vertices
+
+			if (out.cols != nullptr) // otherwise derived_color.vert works the same colour out from p1
+			{
+				// Deterministic color based on vertex positions
+				glm::vec3 color = glm::vec3((p1.x + 1.0f) / 2.0f, (p1.y + 1.0f) / 2.0f, 0.5f); // Color based on point position
+				// all three vertices of a particular triangle will have the same color
+
+				out.cols[next] = color;
+				out.cols[next + 1] = color;
+				out.cols[next + 2] = color;
+			}
+
+			if (out.ancestors != nullptr)
+			{
+				out.ancestors[next] = a1;
+				out.ancestors[next + 1] = a2;
+				out.ancestors[next + 2] = a3;
+			}
+			next += 3;
+		}
+		// recursive case: divide into three smaller triangles
+		else
+		{
+			// these are the midpoints of each side
+			glm::vec3 mid1 = (p1 + p2) / 2.0f;
+			glm::vec3 mid2 = (p2 + p3) / 2.0f;
+			glm::vec3 mid3 = (p1 + p3) / 2.0f;
+
+			// recursively call the generate function on the three smaller triangles
+			// each one grows out of this triangle, so this triangle's corners are their ancestors
+			generate(p1, mid1, mid3, depth - 1, p1, p2, p3);
+			generate(mid1, p2, mid2, depth - 1, p1, p2, p3);
+			generate(mid3, mid2, p3, depth - 1, p1, p2, p3);
+		}
+	};
+
+	// this is the initial call to the generate function with the main triangle
+	glm::vec3 p1(-0.5f, -0.5f, 0.f), p2(0.5f, -0.5f, 0.f), p3(0.f, 0.5f, 0.f);
+	generate(p1, p2, p3, depth, p1, p2, p3);
+}
+
+size_t sierpinskiInstanceCount(int depth)
+{
+	return powerOf(3, depth);
+}
+
+void generateSierpinskiInstances(glm::vec3 *instances, int depth)
+{
+	size_t next = 0;
+	const float leafScale = std::ldexp(1.0f, -depth); // halved at every level
+
+	// the same recursion as the triangles, but a leaf only keeps its first corner
+	std::function<void(glm::vec3, glm::vec3, glm::vec3, int)> generate =
+		[&](glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, int depth)
+	{
+		if (depth == 0)
+		{
+			instances[next++] = glm::vec3(p1.x, p1.y, leafScale);
+			return;
+		}
+		glm::vec3 mid1 = (p1 + p2) / 2.0f;
+		glm::vec3 mid2 = (p2 + p3) / 2.0f;
+		glm::vec3 mid3 = (p1 + p3) / 2.0f;
+		generate(p1, mid1, mid3, depth - 1);
+		generate(mid1, p2, mid2, depth - 1);
+		generate(mid3, mid2, p3, depth - 1);
+	};
+	generate(glm::vec3(-0.5f, -0.5f, 0.f), glm::vec3(0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.5f, 0.f), depth);
+}
+
+size_t sierpinskiHolesVertexCount(int depth)
+{ // the root and 1 + 3 + ... + 3^(depth-1) holes
+	return 3 * (1 + (powerOf(3, depth) - 1) / 2);
+}
+
+void generateSierpinskiHoles(const GeometryOutput &out, int depth, glm::vec3 background)
+{
+	size_t next = 0;
+	auto emit = [&](glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, glm::vec3 color)
+	{
+		const glm::vec3 corners[3] = {p1, p2, p3};
+		for (int i = 0; i < 3; i++)
+		{
+			out.verts[next + i] = corners[i];
+			if (out.cols != nullptr)
+			{
+				out.cols[next + i] = color;
+			}
+			if (out.ancestors != nullptr)
+			{ // holes don't morph, they stay where they are
+				out.ancestors[next + i] = corners[i];
+			}
+		}
+		next += 3;
+	};
+
+	// the same recursion as generateSierpinskiTriangle, but it keeps the middle triangles it skips
+	std::function<void(glm::vec3, glm::vec3, glm::vec3, int)> generate =
+		[&](glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, int depth)
+	{
+		if (depth == 0)
+		{
+			return;
+		}
+		glm::vec3 mid1 = (p1 + p2) / 2.0f;
+		glm::vec3 mid2 = (p2 + p3) / 2.0f;
+		glm::vec3 mid3 = (p1 + p3) / 2.0f;
+		emit(mid1, mid2, mid3, background);
+		generate(p1, mid1, mid3, depth - 1);
+		generate(mid1, p2, mid2, depth - 1);
+		generate(mid3, mid2, p3, depth - 1);
+	};
+
+	glm::vec3 p1(-0.5f, -0.5f, 0.f), p2(0.5f, -0.5f, 0.f), p3(0.f, 0.5f, 0.f);
+	emit(p1, p2, p3, glm::vec3((p1.x + 1.0f) / 2.0f, (p1.y + 1.0f) / 2.0f, 0.5f)); // the depth 0 colour, for basic.frag
+	generate(p1, p2, p3, depth);
+}
+
+void generateLevyCurve(CPU_Geometry &cpuGeom, int depth, bool withAncestors)
+{
+	generateLevyCurve(prepareOutput(cpuGeom, levyVertexCount(depth), withAncestors), depth);
+}
+
+void generateLevyCurve(const GeometryOutput &out, int depth)
+{ // for the c levy curve fractal
+	size_t next = 0;
+
+	// a1 and a2 are where p1 and p2 were on the segment one depth up
+	std::function<void(glm::vec3, glm::vec3, int, float, float, glm::vec3, glm::vec3)> generate =
+		[&](glm::vec3 p1, glm::vec3 p2, int depth, float t1, float t2, glm::vec3 a1, glm::vec3 a2)
+	{
+		if (depth == 0)
+		{
+			// the output holds all points making the curve, so we write the two points
+			// in the base case, there are only two
+			out.verts[next] = p1;
+			out.verts[next + 1] = p2;
+
+			if (out.cols != nullptr)
+			{
+				// Gradient color calculation proceeds based on t1 and t2, which are the t values (a t value is a value between 0 and 1 used for interpolation)
+				glm::vec3 color1 = glm::mix(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), t1); // Red to Green
+				glm::vec3 color2 = glm::mix(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), t2);
+
+				out.cols[next] = color1;
+				out.cols[next + 1] = color2; // added the two colours of line segment
+			}
+			if (out.shades != nullptr)
+			{ // t is a multiple of 1/2^depth, 16 bits keep it to well under a colour step
+				out.shades[next] = static_cast<std::uint16_t>(t1 * 65535.0f + 0.5f);
+				out.shades[next + 1] = static_cast<std::uint16_t>(t2 * 65535.0f + 0.5f);
+			}
+
+			if (out.ancestors != nullptr)
+			{
+				out.ancestors[next] = a1;
+				out.ancestors[next + 1] = a2;
+			}
+			next += 2;
+		}
+		else
+		{
+			glm::vec3 mid = (p1 + p2) / 2.0f; // take the mid point where the next line will be drawn
+			glm::vec3 straightMid = mid;	  // before it is pushed out, this is where the new corner morphs from
+			glm::vec3 dir = p2 - p1;		  // find a directional vector
+			glm::vec3 perp = glm::vec3(-dir.y, dir.x, 0.0f);
+			// this is the perpendicular vector to the direction vector, which is used to find the next point
+			// we do this by switching the x and y values and negating one of them
+			mid += glm::normalize(perp) * glm::length(dir) * 0.5f;
+			// as defined, we translate the mid point by half the length of the directional vector in the perpendicular direction
+			float midT = (t1 + t2) / 2.0f;
+			// the t value of the mid point is the average of the two t values of the end points, again this is just an interpolation parameter
+
+			generate(p1, mid, depth - 1, t1, midT, p1, straightMid); // recursively generate two more curves from the mid point
+			generate(mid, p2, depth - 1, midT, t2, straightMid, p2);
+		}
+	};
+
+	// we use full interpolation for the first call, so the t values are 0 and 1
+	// interpolation allows us to make the gradient of the line segment
+	glm::vec3 p1(-0.5f, 0.0f, 0.f), p2(0.5f, 0.0f, 0.f);
+	generate(p1, p2, depth, 0.0f, 1.0f, p1, p2);
+}
+
+// Everything the tree recursion needs that doesn't change between branches.
+// The tree is re-evaluated every frame while its sliders are animated, so instead of a
+// std::function (which can't be inlined and costs an indirect call per branch) it recurses
+// through a plain function and writes into an output that was sized once up front
+struct TreeContext
+{
+	GeometryOutput out;
+	size_t next; // next free vertex
+	int depth;
+	float cosA; // precalculate the cos and sin of the angle, once for the whole tree
+	float sinA;
+	float scale;
+	float branchPoint;
+};
+
+static void generateBranch(TreeContext &tree, glm::vec3 start, glm::vec3 end, int currentDepth)
+{
+	tree.out.verts[tree.next] = start; // add two endpoints and draw a line in between them
+	tree.out.verts[tree.next + 1] = end;
+	if (tree.out.cols != nullptr)
+	{
+		// use a ternary operator to determine the color based on the depth, as described in the assignment
+		glm::vec3 color = (currentDepth <= 3) ? glm::vec3(0.4f, 0.3f, 0.2f) : glm::vec3(0.13f, 0.55f, 0.13f);
+		// according to Google, the colours are "darker desaturated brown" and "forest green"
+
+		tree.out.cols[tree.next] = color; // these line segments share the same colour
+		tree.out.cols[tree.next + 1] = color;
+	}
+	if (tree.out.shades != nullptr)
+	{ // the shader picks the colour from the depth
+		tree.out.shades[tree.next] = static_cast<std::uint16_t>(currentDepth);
+		tree.out.shades[tree.next + 1] = static_cast<std::uint16_t>(currentDepth);
+	}
+	if (tree.out.ancestors != nullptr)
+	{
+		// the newest branches grow out of the point they start at, older branches were already there
+		bool newest = currentDepth == tree.depth && currentDepth > 0;
+		tree.out.ancestors[tree.next] = start;
+		tree.out.ancestors[tree.next + 1] = newest ? start : end;
+	}
+	tree.next += 2;
+
+	if (currentDepth < tree.depth) // recursive case
+	{
+		glm::vec3 dir = end - start;			 // finding a directional vector
+		float length = glm::length(dir);		 // finding the length of the directional vector aka "length of the branch"
+		glm::vec3 unitDir = glm::normalize(dir); // normalizing the directional vector so that we can scale it
+		float childLength = length * tree.scale;
+
+		glm::vec3 branch1End = end + unitDir * childLength;			   // the first branch is just a scaled version of the original branch (straight ahead)
+		glm::vec3 branchStart = glm::mix(start, end, tree.branchPoint); // where the side branches grow from (the midpoint by default)
+
+		// we need to rotate to get the other two branches
+		glm::vec3 branch2Dir = glm::vec3(unitDir.x * tree.cosA - unitDir.y * tree.sinA, unitDir.x * tree.sinA + unitDir.y * tree.cosA, 0.0f) * childLength;	 // this is like + angle from vertical, find its endpoint
+		glm::vec3 branch3Dir = glm::vec3(unitDir.x * tree.cosA + unitDir.y * tree.sinA, -unitDir.x * tree.sinA + unitDir.y * tree.cosA, 0.0f) * childLength; // this is like - angle from vertical, find its endpoint
+
+		generateBranch(tree, end, branch1End, currentDepth + 1);					  // first branch
+		generateBranch(tree, branchStart, branchStart + branch2Dir, currentDepth + 1); // second branch
+		generateBranch(tree, branchStart, branchStart + branch3Dir, currentDepth + 1); // third branch, the endpoint is the start plus the rotated vector
+	}
+}
+
+void generateTree(CPU_Geometry &cpuGeom, int depth, const TreeParams &params, bool withAncestors)
+{
+	generateTree(prepareOutput(cpuGeom, treeVertexCount(depth), withAncestors), depth, params);
+}
+
+void generateTree(const GeometryOutput &out, int depth, const TreeParams &params)
+{
+	const float angle = glm::radians(params.angle);
+	TreeContext tree{out, 0, depth, std::cos(angle), std::sin(angle), params.scale, params.branchPoint};
+	generateBranch(tree, glm::vec3(0.0f, -0.8f, 0.0f), glm::vec3(0.0f, -0.3f, 0.0f), 0);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// The three fractal generators. They only fill a CPU_Geometry (or raw memory),
+// so anything that needs fractal geometry (the main window, the forest, ...) can
+// share them.
+//------------------------------------------------------------------------------
+
+#include "Geometry.h"
+
+// The tree's shape, exposed so it can be changed (and animated) live from the UI
+struct TreeParams
+{
+	float angle = 25.7f;	  // degrees between the side branches and their parent, as defined in the assignment
+	float scale = 0.5f;		  // length of every child branch relative to its parent
+	float branchPoint = 0.5f; // how far along the parent the side branches start (0 = base, 1 = tip)
+};
+
+// The size of every fractal is known before generating it, so the output (a GeometryOutput)
+// can be sized exactly, in a CPU_Geometry or in mapped GPU memory
+size_t sierpinskiVertexCount(int depth);
+size_t levyVertexCount(int depth);
+size_t treeVertexCount(int depth);
+
+// Every endpoint of the depth d Levy curve is an exact multiple of this in x and y (each level turns
+// the segments by 45 degrees and shrinks them by sqrt(2), so the lattice halves every second level)
+float levyLatticeStep(int depth);
+
+// withAncestors also fills cpuGeom.ancestors with where every vertex was one depth up,
+// which is what the depth morph in basic.vert blends from
+void generateSierpinskiTriangle(CPU_Geometry &cpuGeom, int depth, bool withAncestors = false);
+void generateLevyCurve(CPU_Geometry &cpuGeom, int depth, bool withAncestors = false);
+void generateTree(CPU_Geometry &cpuGeom, int depth, const TreeParams &params = TreeParams(), bool withAncestors = false);
+
+// The same generators writing straight into an output with room for exactly *VertexCount(depth) vertices
+void generateSierpinskiTriangle(const GeometryOutput &out, int depth);
+void generateLevyCurve(const GeometryOutput &out, int depth);
+void generateTree(const GeometryOutput &out, int depth, const TreeParams &params = TreeParams());
+
+// Every leaf triangle of the Sierpinski triangle is the root triangle scaled by 2^-depth, so it is
+// fully described by its first corner and that scale. Writes sierpinskiInstanceCount(depth) of them
+// as (x, y, scale), in the same order generateSierpinskiTriangle writes the triangles
+size_t sierpinskiInstanceCount(int depth);
+void generateSierpinskiInstances(glm::vec3 *instances, int depth);
+
+// The complement of the Sierpinski triangle: the root triangle, then the hole cut out at every
+// level (the middle triangle of every subdivided triangle, (3^depth - 1) / 2 of them) in the
+// background colour, to be drawn in that order. Roughly half the triangles of the leaves, but
+// one triangle can't carry the leaves' colours, the root is meant for a shader that works them
+// out per pixel (sierpinski_regions.frag). Writes sierpinskiHolesVertexCount(depth) vertices
+size_t sierpinskiHolesVertexCount(int depth);
+void generateSierpinskiHoles(const GeometryOutput &out, int depth, glm::vec3 background = glm::vec3(0.0f));
@@ -0,0 +1,189 @@
+#include "FrameStats.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cstdio>
+
+
+// About 4.5 hours at 60 Hz, 100 MB or so. Past that the oldest half is dropped from the CSV
+static const size_t historyLimit = size_t(1) << 20;
+
+static const char *phaseNames[] = {"events", "ui", "generate", "draw", "swap"};
+
+const char *framePhaseName(FramePhase phase) {
+	return phaseNames[static_cast<size_t>(phase)];
+}
+
+
+FrameStats::FrameStats(size_t window)
+	: budgetMs(1000.0 / 60.0 * 1.5)
+	, window(std::max<size_t>(window, 1))
+	, frameCount(0)
+	, hitchCount(0)
+	, inFrame(false)
+	, phase(FramePhase::Events)
+	, chargedAway(0.0)
+	, lastHitchLogSeconds(-1.0)
+	, hitchesNotLogged(0)
+{}
+
+
+void FrameStats::beginFrame() {
+	const Clock::time_point now = Clock::now();
+	if (frameCount == 0) {
+		firstFrameStart = now;
+	}
+	current = FrameRecord();
+	current.frame = frameCount;
+	current.startSeconds = std::chrono::duration<double>(now - firstFrameStart).count();
+	frameStart = now;
+	phaseStart = now;
+	phase = FramePhase::Events;
+	chargedAway = 0.0;
+	inFrame = true;
+}
+
+
+void FrameStats::closePhase(Clock::time_point now) {
+	const double ms = std::chrono::duration<double, std::milli>(now - phaseStart).count();
+	current.phaseMs[static_cast<size_t>(phase)] += std::max(0.0, ms - chargedAway);
+	phaseStart = now;
+	chargedAway = 0.0;
+}
+
+
+void FrameStats::beginPhase(FramePhase next) {
+	if (!inFrame) {
+		return;
+	}
+	closePhase(Clock::now());
+	phase = next;
+}
+
+
+void FrameStats::charge(FramePhase to, double ms) {
+	if (!inFrame || to == phase) {
+		return;
+	}
+	current.phaseMs[static_cast<size_t>(to)] += ms;
+	chargedAway += ms;
+}
+
+
+void FrameStats::note(const std::string &what) {
+	if (!inFrame) {
+		return;
+	}
+	if (!current.notes.empty()) {
+		current.notes += "; ";
+	}
+	current.notes += what;
+}
+
+
+void FrameStats::endFrame() {
+	if (!inFrame) {
+		return;
+	}
+	const Clock::time_point now = Clock::now();
+	closePhase(now);
+	current.totalMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+	inFrame = false;
+
+	if (history.size() == historyLimit) {
+		history.erase(history.begin(), history.begin() + historyLimit / 2);
+	}
+	history.push_back(std::move(current));
+	frameCount++;
+
+	// the first frame compiles shaders and generates the first fractal, it's always slow
+	if (history.back().totalMs > budgetMs && history.back().frame > 0) {
+		hitchCount++;
+		reportHitch(history.back());
+	}
+}
+
+
+void FrameStats::reportHitch(const FrameRecord &record) {
+	if (lastHitchLogSeconds >= 0.0 && record.startSeconds - lastHitchLogSeconds < 1.0) {
+		hitchesNotLogged++;
+		return;
+	}
+	size_t slowest = 0;
+	std::string phases;
+	for (size_t i = 0; i < record.phaseMs.size(); i++) {
+		if (record.phaseMs[i] > record.phaseMs[slowest]) {
+			slowest = i;
+		}
+		phases += fmt::format("{}{} {:.2f}", i == 0 ? "" : ", ", phaseNames[i], record.phaseMs[i]);
+	}
+	std::string skipped = hitchesNotLogged > 0 ? fmt::format(" ({} more since the last)", hitchesNotLogged) : "";
+	Log::warning("HITCH frame {}: {:.2f} ms over a {:.2f} ms budget, mostly {} ({}){}{}{}", record.frame, record.totalMs,
+				 budgetMs, phaseNames[slowest], phases, record.notes.empty() ? "" : ": ", record.notes, skipped);
+	lastHitchLogSeconds = record.startSeconds;
+	hitchesNotLogged = 0;
+}
+
+
+FrameSummary FrameStats::summarize(std::vector<double> &times) const {
+	FrameSummary summary;
+	if (times.empty()) {
+		return summary;
+	}
+	std::sort(times.begin(), times.end());
+	auto rank = [&](double p) { // nearest rank
+		size_t index = static_cast<size_t>(p / 100.0 * times.size() + 0.999999);
+		return times[std::min(times.size(), std::max<size_t>(index, 1)) - 1];
+	};
+	summary.p50 = rank(50.0);
+	summary.p95 = rank(95.0);
+	summary.p99 = rank(99.0);
+	summary.max = times.back();
+	return summary;
+}
+
+
+FrameSummary FrameStats::summary() const {
+	std::vector<double> times;
+	for (size_t i = history.size() - std::min(window, history.size()); i < history.size(); i++) {
+		times.push_back(history[i].totalMs);
+	}
+	return summarize(times);
+}
+
+
+FrameSummary FrameStats::summary(FramePhase which) const {
+	std::vector<double> times;
+	for (size_t i = history.size() - std::min(window, history.size()); i < history.size(); i++) {
+		times.push_back(history[i].phaseMs[static_cast<size_t>(which)]);
+	}
+	return summarize(times);
+}
+
+
+bool FrameStats::writeCsv(const std::string &path) const {
+	std::FILE *file = std::fopen(path.c_str(), "w");
+	if (file == nullptr) {
+		return false;
+	}
+	std::fputs("frame,start_s,total_ms", file);
+	for (const char *name : phaseNames) {
+		std::fprintf(file, ",%s_ms", name);
+	}
+	std::fputs(",hitch,notes\n", file);
+	for (const FrameRecord &record : history) {
+		std::string notes = record.notes; // quoted, with the quotes inside doubled
+		for (size_t at = notes.find('"'); at != std::string::npos; at = notes.find('"', at + 2)) {
+			notes.insert(at, 1, '"');
+		}
+		std::string row = fmt::format("{},{:.6f},{:.4f}", record.frame, record.startSeconds, record.totalMs);
+		for (double ms : record.phaseMs) {
+			row += fmt::format(",{:.4f}", ms);
+		}
+		row += fmt::format(",{},\"{}\"\n", record.totalMs > budgetMs && record.frame > 0 ? 1 : 0, notes);
+		std::fputs(row.c_str(), file);
+	}
+	std::fclose(file);
+	return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// CPU time of every frame of the render loop, split into the phases a frame
+// goes through. The loop marks where each phase starts; work that belongs to
+// another phase but runs in the middle of one (a slider that regenerates the
+// fractal while the panel is built) is charged to the phase it belongs to.
+//
+// The last few hundred frames give the rolling percentiles shown in the panel.
+// A frame over budget is a hitch, and is logged with its slowest phase and
+// whatever was noted during it (a regeneration, a benchmark), which is usually
+// the reason. Every frame is kept for the CSV export.
+//------------------------------------------------------------------------------
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+enum class FramePhase
+{
+	Events,	  // glfwPollEvents, and the callbacks it runs
+	Ui,		  // building the ImGui panel
+	Generate, // regenerating, uploading, picking, the benchmarks
+	Draw,	  // the clears and the draw calls, the fractal's and ImGui's
+	Swap,	  // swapBuffers, which waits for vsync
+	Count
+};
+
+const char *framePhaseName(FramePhase phase);
+
+struct FrameRecord
+{
+	size_t frame = 0;
+	double startSeconds = 0.0; // since the first frame
+	double totalMs = 0.0;
+	std::array<double, static_cast<size_t>(FramePhase::Count)> phaseMs{};
+	std::string notes; // what happened during the frame, "; " separated
+};
+
+struct FrameSummary
+{
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+};
+
+class FrameStats {
+
+public:
+	// window: how many of the last frames the percentiles cover
+	explicit FrameStats(size_t window = 600);
+
+	void beginFrame();
+	// Ends the current phase, a phase can be entered several times a frame
+	void beginPhase(FramePhase phase);
+	// ms of the current phase that really belong to phase, moved over when the current phase ends
+	void charge(FramePhase phase, double ms);
+	// Attached to the current frame, for the hitch log and the CSV
+	void note(const std::string &what);
+	void endFrame();
+
+	FrameSummary summary() const;
+	FrameSummary summary(FramePhase phase) const;
+	const FrameRecord *last() const { return history.empty() ? nullptr : &history.back(); }
+	size_t frames() const { return frameCount; }
+	size_t hitches() const { return hitchCount; }
+
+	// Frames longer than this are hitches. With vsync a frame that misses one takes two refresh
+	// periods, so somewhere between one and two catches every miss without flagging jitter
+	double budgetMs;
+
+	// One row per frame, every phase in ms. Returns false if the file can't be written
+	bool writeCsv(const std::string &path) const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	FrameSummary summarize(std::vector<double> &times) const;
+	void closePhase(Clock::time_point now);
+	void reportHitch(const FrameRecord &record);
+
+	size_t window;
+	std::vector<FrameRecord> history; // every frame, up to historyLimit
+	size_t frameCount;
+	size_t hitchCount;
+
+	bool inFrame;
+	FrameRecord current;
+	Clock::time_point firstFrameStart;
+	Clock::time_point frameStart;
+	Clock::time_point phaseStart;
+	FramePhase phase;
+	double chargedAway; // ms of the open phase charged to others
+
+	// consecutive hitches (an animation at a depth that is too slow) are logged once a second at most
+	double lastHitchLogSeconds;
+	size_t hitchesNotLogged;
+};
@@ -0,0 +1,47 @@
+#include "Framebuffer.h"
+
+#include "GLState.h"
+
+#include <stdexcept>
+
+
+Framebuffer::Framebuffer(GLenum internalFormat, GLint filter)
+	: framebufferID()
+	, textureID()
+	, internalFormat(internalFormat)
+	, size(0)
+{
+	GLState::bindTexture(GL_TEXTURE_2D, textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0); // no mipmaps, or the texture is incomplete
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+void Framebuffer::resize(glm::ivec2 newSize) {
+	if (newSize == size) {
+		return;
+	}
+	size = newSize;
+
+	GLState::bindTexture(GL_TEXTURE_2D, textureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+	const GLuint previous = GLState::drawFramebuffer();
+	bind();
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textureID, 0);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, previous);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		throw std::runtime_error("Framebuffer incomplete");
+	}
+}
+
+
+void Framebuffer::bindTexture(GLuint unit) const {
+	GLState::bindTexture(unit, GL_TEXTURE_2D, textureID);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "GLHandles.h"
+#include "GLState.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// An offscreen render target: a framebuffer with one colour texture attached,
+// which shaders can sample once it has been drawn into
+class Framebuffer {
+
+public:
+	// internalFormat is any (non-integer) colour format, e.g. GL_RGBA8.
+	// filter is how the texture is sampled afterwards (GL_NEAREST or GL_LINEAR)
+	Framebuffer(GLenum internalFormat, GLint filter);
+	// Rule of zero, the handles clean up after themselves
+
+	// Public interface
+	// Reallocates the texture only when the size changes, the contents are undefined afterwards.
+	// Throws if the driver can't render to the format
+	void resize(glm::ivec2 size);
+	glm::ivec2 getSize() const { return size; }
+
+	void bind() const { GLState::bindFramebuffer(GL_FRAMEBUFFER, framebufferID); }
+	void bindTexture(GLuint unit) const;
+
+	GLuint framebuffer() const { return framebufferID; }
+	GLuint texture() const { return textureID; }
+
+private:
+	FramebufferHandle framebufferID;
+	TextureHandle textureID;
+	GLenum internalFormat;
+	glm::ivec2 size;
+};
@@ -1,4 +1,5 @@
 #include "GLDebug.h"
+#include "GLState.h"
 #include "Log.h"
 
 #include <regex>
@@ -69,8 +70,8 @@ void GLDebug::enable() {
 	if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
 	{
 		// initialize debug output
-		glEnable(GL_DEBUG_OUTPUT);
-		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		GLState::enable(GL_DEBUG_OUTPUT);
+		GLState::enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
 		glDebugMessageCallback(GLDebug::debugOutputHandler, nullptr);
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
 		Log::info("Enabling debug mode for opengl");
@@ -181,3 +181,85 @@ private:
 	GLuint textureID;
 
 };
+
+// An RAII class for managing a Query GLuint for OpenGL (used for GPU timers).
+class QueryHandle {
+
+public:
+	QueryHandle();
+
+	// Disallow copying
+	QueryHandle(const QueryHandle&) = delete;
+	QueryHandle operator=(const QueryHandle&) = delete;
+
+	// Allow moving
+	QueryHandle(QueryHandle&& other) noexcept;
+	QueryHandle& operator=(QueryHandle&& other) noexcept;
+
+	// Clean up after ourselves.
+	~QueryHandle();
+
+	// Allow casting from this type into a GLuint
+	// This allows usage in situations where a function expects a GLuint
+	operator GLuint() const;
+	GLuint value() const;
+
+private:
+	GLuint queryID;
+
+};
+
+// An RAII class for managing a Shader Storage Buffer GLuint for OpenGL (compute backend, GL 4.3+).
+// Creating and deleting it is the same as any buffer, only binding it needs 4.3
+class ShaderStorageBufferHandle {
+
+public:
+	ShaderStorageBufferHandle();
+
+	// Disallow copying
+	ShaderStorageBufferHandle(const ShaderStorageBufferHandle&) = delete;
+	ShaderStorageBufferHandle operator=(const ShaderStorageBufferHandle&) = delete;
+
+	// Allow moving
+	ShaderStorageBufferHandle(ShaderStorageBufferHandle&& other) noexcept;
+	ShaderStorageBufferHandle& operator=(ShaderStorageBufferHandle&& other) noexcept;
+
+	// Clean up after ourselves.
+	~ShaderStorageBufferHandle();
+
+	// Allow casting from this type into a GLuint
+	// This allows usage in situations where a function expects a GLuint
+	operator GLuint() const;
+	GLuint value() const;
+
+private:
+	GLuint bufferID;
+
+};
+
+// An RAII class for managing a Framebuffer GLuint for OpenGL (offscreen render targets).
+class FramebufferHandle {
+
+public:
+	FramebufferHandle();
+
+	// Disallow copying
+	FramebufferHandle(const FramebufferHandle&) = delete;
+	FramebufferHandle operator=(const FramebufferHandle&) = delete;
+
+	// Allow moving
+	FramebufferHandle(FramebufferHandle&& other) noexcept;
+	FramebufferHandle& operator=(FramebufferHandle&& other) noexcept;
+
+	// Clean up after ourselves.
+	~FramebufferHandle();
+
+	// Allow casting from this type into a GLuint
+	// This allows usage in situations where a function expects a GLuint
+	operator GLuint() const;
+	GLuint value() const;
+
+private:
+	GLuint framebufferID;
+
+};
@@ -0,0 +1,401 @@
+#include "GLState.h"
+
+#include "Log.h"
+
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+	// Not a name GL hands out, marks what the cache doesn't know
+	const GLuint unknown = ~GLuint(0);
+
+	// The buffer targets that are cached, in the order of State::buffers
+	const GLenum bufferTargets[] = {
+		GL_ARRAY_BUFFER,
+		GL_TRANSFORM_FEEDBACK_BUFFER,
+#ifdef GL_VERSION_4_3
+		GL_SHADER_STORAGE_BUFFER,
+#endif
+	};
+	const GLenum bufferQueries[] = {
+		GL_ARRAY_BUFFER_BINDING,
+		GL_TRANSFORM_FEEDBACK_BUFFER_BINDING,
+#ifdef GL_VERSION_4_3
+		GL_SHADER_STORAGE_BUFFER_BINDING,
+#endif
+	};
+	const size_t bufferCount = sizeof(bufferTargets) / sizeof(bufferTargets[0]);
+
+	// The texture targets that are cached, on the first textureUnits units
+	const GLenum textureTargets[] = {GL_TEXTURE_2D, GL_TEXTURE_1D_ARRAY};
+	const GLenum textureQueries[] = {GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_1D_ARRAY};
+	const size_t textureTargetCount = 2;
+	const GLuint textureUnits = 16; // what GL 3.3 guarantees to fragment shaders
+
+	struct State
+	{
+		GLuint program = unknown;
+		GLuint vertexArray = unknown;
+		GLuint buffers[bufferCount];
+		GLuint activeUnit = unknown; // 0 for GL_TEXTURE0
+		GLuint textures[textureUnits][textureTargetCount];
+		GLuint drawFramebuffer = unknown;
+		GLuint readFramebuffer = unknown;
+		std::vector<std::pair<GLenum, bool>> capabilities; // only the known ones
+
+		State() { forgetAll(); }
+
+		void forgetAll() {
+			program = unknown;
+			vertexArray = unknown;
+			for (GLuint &buffer : buffers) {
+				buffer = unknown;
+			}
+			activeUnit = unknown;
+			for (auto &unit : textures) {
+				for (GLuint &texture : unit) {
+					texture = unknown;
+				}
+			}
+			drawFramebuffer = unknown;
+			readFramebuffer = unknown;
+			capabilities.clear();
+		}
+	};
+
+	State state;
+	GLState::Counters tally;
+	bool validating = false;
+
+	size_t kindIndex(GLState::Kind kind) {
+		return static_cast<size_t>(kind);
+	}
+
+	int bufferIndex(GLenum target) {
+		for (size_t i = 0; i < bufferCount; i++) {
+			if (bufferTargets[i] == target) {
+				return static_cast<int>(i);
+			}
+		}
+		return -1;
+	}
+
+	int textureIndex(GLenum target) {
+		for (size_t i = 0; i < textureTargetCount; i++) {
+			if (textureTargets[i] == target) {
+				return static_cast<int>(i);
+			}
+		}
+		return -1;
+	}
+
+	GLuint query(GLenum parameter) {
+		GLint value = 0;
+		glGetIntegerv(parameter, &value);
+		return static_cast<GLuint>(value);
+	}
+
+	// Validation: is the cached value what GL has? Logs it when not
+	bool matches(GLState::Kind kind, const char *what, GLuint cached, GLuint actual) {
+		if (cached == actual) {
+			return true;
+		}
+		tally.mismatches++;
+		Log::error("GL_STATE {} {}: cached {}, actually {}", GLState::kindName(kind), what, cached, actual);
+		return false;
+	}
+
+	// The shared part of every cached change. issue() makes the GL call, check() is validation's glGet
+	template <typename Issue, typename Check>
+	void change(GLState::Kind kind, GLuint &cached, GLuint wanted, Issue issue, Check check) {
+		if (cached == wanted && !(validating && !check())) {
+			tally.skipped[kindIndex(kind)]++;
+			return;
+		}
+		issue();
+		cached = wanted;
+		tally.issued[kindIndex(kind)]++;
+	}
+
+	void activeUnit(GLuint unit) {
+		change(GLState::Kind::Texture, state.activeUnit, unit, [&] { glActiveTexture(GL_TEXTURE0 + unit); },
+			   [&] { return matches(GLState::Kind::Texture, "active unit", unit, query(GL_ACTIVE_TEXTURE) - GL_TEXTURE0); });
+	}
+
+	void setCapability(GLenum capability, bool enabled) {
+		auto known = state.capabilities.begin();
+		while (known != state.capabilities.end() && known->first != capability) {
+			++known;
+		}
+		auto check = [&] {
+			return matches(GLState::Kind::Capability, "enabled", enabled, glIsEnabled(capability) == GL_TRUE);
+		};
+		if (known != state.capabilities.end() && known->second == enabled && !(validating && !check())) {
+			tally.skipped[kindIndex(GLState::Kind::Capability)]++;
+			return;
+		}
+		if (enabled) {
+			glEnable(capability);
+		}
+		else {
+			glDisable(capability);
+		}
+		if (known == state.capabilities.end()) {
+			state.capabilities.emplace_back(capability, enabled);
+		}
+		else {
+			known->second = enabled;
+		}
+		tally.issued[kindIndex(GLState::Kind::Capability)]++;
+	}
+
+}
+
+
+void GLState::useProgram(GLuint program) {
+	change(Kind::Program, state.program, program, [&] { glUseProgram(program); },
+		   [&] { return matches(Kind::Program, "current", program, query(GL_CURRENT_PROGRAM)); });
+}
+
+
+void GLState::bindVertexArray(GLuint vertexArray) {
+	change(Kind::VertexArray, state.vertexArray, vertexArray, [&] { glBindVertexArray(vertexArray); },
+		   [&] { return matches(Kind::VertexArray, "bound", vertexArray, query(GL_VERTEX_ARRAY_BINDING)); });
+}
+
+
+void GLState::bindBuffer(GLenum target, GLuint buffer) {
+	const int i = bufferIndex(target);
+	if (i < 0) {
+		glBindBuffer(target, buffer);
+		tally.issued[kindIndex(Kind::Buffer)]++;
+		return;
+	}
+	change(Kind::Buffer, state.buffers[i], buffer, [&] { glBindBuffer(target, buffer); },
+		   [&] { return matches(Kind::Buffer, "bound", buffer, query(bufferQueries[i])); });
+}
+
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+	glBindBufferBase(target, index, buffer);
+	tally.issued[kindIndex(Kind::Buffer)]++;
+	const int i = bufferIndex(target);
+	if (i >= 0) {
+		state.buffers[i] = buffer;
+	}
+}
+
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+	activeUnit(unit);
+	bindTexture(target, texture);
+}
+
+
+void GLState::bindTexture(GLenum target, GLuint texture) {
+	const int i = textureIndex(target);
+	if (i < 0 || state.activeUnit >= textureUnits) { // includes an unknown unit
+		glBindTexture(target, texture);
+		tally.issued[kindIndex(Kind::Texture)]++;
+		if (i >= 0 && state.activeUnit == unknown) { // whichever unit it was, it may hold this texture now
+			for (auto &unit : state.textures) {
+				unit[i] = unknown;
+			}
+		}
+		return;
+	}
+	change(Kind::Texture, state.textures[state.activeUnit][i], texture, [&] { glBindTexture(target, texture); },
+		   [&] { return matches(Kind::Texture, "bound", texture, query(textureQueries[i])); });
+}
+
+
+void GLState::bindFramebuffer(GLenum target, GLuint framebuffer) {
+	const bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+	const bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+	auto check = [&] {
+		return (!draw || matches(Kind::Framebuffer, "draw", framebuffer, query(GL_DRAW_FRAMEBUFFER_BINDING))) &&
+			   (!read || matches(Kind::Framebuffer, "read", framebuffer, query(GL_READ_FRAMEBUFFER_BINDING)));
+	};
+	if ((!draw || state.drawFramebuffer == framebuffer) && (!read || state.readFramebuffer == framebuffer) &&
+		!(validating && !check())) {
+		tally.skipped[kindIndex(Kind::Framebuffer)]++;
+		return;
+	}
+	glBindFramebuffer(target, framebuffer);
+	if (draw) {
+		state.drawFramebuffer = framebuffer;
+	}
+	if (read) {
+		state.readFramebuffer = framebuffer;
+	}
+	tally.issued[kindIndex(Kind::Framebuffer)]++;
+}
+
+
+GLuint GLState::drawFramebuffer() {
+	if (state.drawFramebuffer == unknown) {
+		state.drawFramebuffer = query(GL_DRAW_FRAMEBUFFER_BINDING);
+	}
+	return state.drawFramebuffer;
+}
+
+
+void GLState::enable(GLenum capability) {
+	setCapability(capability, true);
+}
+
+
+void GLState::disable(GLenum capability) {
+	setCapability(capability, false);
+}
+
+
+bool GLState::isEnabled(GLenum capability) {
+	for (const auto &known : state.capabilities) {
+		if (known.first == capability) {
+			return known.second;
+		}
+	}
+	const bool enabled = glIsEnabled(capability) == GL_TRUE;
+	state.capabilities.emplace_back(capability, enabled);
+	return enabled;
+}
+
+
+void GLState::forgetProgram(GLuint program) {
+	if (program != 0 && state.program == program) { // deleting the current program only flags it, it stays in use
+		state.program = unknown;
+	}
+}
+
+
+void GLState::forgetVertexArray(GLuint vertexArray) {
+	if (state.vertexArray == vertexArray) {
+		state.vertexArray = 0;
+	}
+}
+
+
+void GLState::forgetBuffer(GLuint buffer) {
+	for (GLuint &bound : state.buffers) {
+		if (bound == buffer) {
+			bound = 0;
+		}
+	}
+}
+
+
+void GLState::forgetTexture(GLuint texture) {
+	for (auto &unit : state.textures) {
+		for (GLuint &bound : unit) {
+			if (bound == texture) {
+				bound = 0;
+			}
+		}
+	}
+}
+
+
+void GLState::forgetFramebuffer(GLuint framebuffer) {
+	if (state.drawFramebuffer == framebuffer) {
+		state.drawFramebuffer = 0;
+	}
+	if (state.readFramebuffer == framebuffer) {
+		state.readFramebuffer = 0;
+	}
+}
+
+
+void GLState::invalidate() {
+	state.forgetAll();
+}
+
+
+size_t GLState::validate() {
+	const size_t before = tally.mismatches;
+	auto check = [](Kind kind, const char *what, GLuint &cached, GLuint actual) {
+		if (cached != unknown && !matches(kind, what, cached, actual)) {
+			cached = actual;
+		}
+	};
+	check(Kind::Program, "current", state.program, query(GL_CURRENT_PROGRAM));
+	check(Kind::VertexArray, "bound", state.vertexArray, query(GL_VERTEX_ARRAY_BINDING));
+	for (size_t i = 0; i < bufferCount; i++) {
+		check(Kind::Buffer, "bound", state.buffers[i], query(bufferQueries[i]));
+	}
+	check(Kind::Framebuffer, "draw", state.drawFramebuffer, query(GL_DRAW_FRAMEBUFFER_BINDING));
+	check(Kind::Framebuffer, "read", state.readFramebuffer, query(GL_READ_FRAMEBUFFER_BINDING));
+	for (auto &known : state.capabilities) {
+		const bool actual = glIsEnabled(known.first) == GL_TRUE;
+		if (!matches(Kind::Capability, "enabled", known.second, actual)) {
+			known.second = actual;
+		}
+	}
+
+	// every unit has to be made active to ask what is bound on it, then back to the one that was
+	const GLuint active = query(GL_ACTIVE_TEXTURE) - GL_TEXTURE0;
+	check(Kind::Texture, "active unit", state.activeUnit, active);
+	for (GLuint unit = 0; unit < textureUnits; unit++) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		for (size_t i = 0; i < textureTargetCount; i++) {
+			check(Kind::Texture, "bound", state.textures[unit][i], query(textureQueries[i]));
+		}
+	}
+	glActiveTexture(GL_TEXTURE0 + active);
+	return tally.mismatches - before;
+}
+
+
+bool GLState::validationAvailable() {
+#ifndef NDEBUG
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+void GLState::setValidation(bool enabled) {
+	validating = enabled && validationAvailable();
+}
+
+
+bool GLState::validation() {
+	return validating;
+}
+
+
+const char *GLState::kindName(Kind kind) {
+	static const char *names[] = {"program", "vertex array", "buffer", "texture", "framebuffer", "capability"};
+	return names[kindIndex(kind)];
+}
+
+
+size_t GLState::Counters::totalIssued() const {
+	size_t total = 0;
+	for (size_t count : issued) {
+		total += count;
+	}
+	return total;
+}
+
+
+size_t GLState::Counters::totalSkipped() const {
+	size_t total = 0;
+	for (size_t count : skipped) {
+		total += count;
+	}
+	return total;
+}
+
+
+const GLState::Counters &GLState::counters() {
+	return tally;
+}
+
+
+void GLState::resetCounters() {
+	tally = Counters();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// A cache of the GL state the wrappers change: the program, the vertex array,
+// buffer bindings, the active texture unit and the textures bound on each unit,
+// the framebuffers and enabled capabilities. The wrappers (ShaderProgram::use,
+// VertexArray::bind, ...) change state through here, and a change to what is
+// already set is skipped, along with its driver call and the revalidation some
+// drivers do at the next draw after any state change.
+//
+// It only knows what went through it. GL code that changes the same state
+// directly has to be followed by invalidate(). ImGui's backend restores
+// everything it touches, so it doesn't need that. GL reuses deleted names, so
+// the handles in GLHandles.h report their deletion here.
+//
+// Builds without NDEBUG can turn on validation: every skipped change is first
+// checked against glGet*, and a mismatch is logged and then made anyway.
+//------------------------------------------------------------------------------
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+namespace GLState {
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vertexArray);
+	// GL_ARRAY_BUFFER, GL_TRANSFORM_FEEDBACK_BUFFER and GL_SHADER_STORAGE_BUFFER are cached, other targets pass through
+	void bindBuffer(GLenum target, GLuint buffer);
+	// Always issued, the indexed bindings aren't cached. It binds the generic binding point as well
+	void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	// Makes unit the active unit and binds texture there. GL_TEXTURE_2D and GL_TEXTURE_1D_ARRAY are cached
+	void bindTexture(GLuint unit, GLenum target, GLuint texture);
+	// On whichever unit is active, to set a texture up
+	void bindTexture(GLenum target, GLuint texture);
+	// GL_FRAMEBUFFER binds both the draw and the read framebuffer
+	void bindFramebuffer(GLenum target, GLuint framebuffer);
+	// The bound draw framebuffer, from the cache when it is known (glGet waits for the driver's thread)
+	GLuint drawFramebuffer();
+
+	void enable(GLenum capability);
+	void disable(GLenum capability);
+	bool isEnabled(GLenum capability);
+
+	// The name is about to be deleted. Where it was bound GL falls back to 0 (a program stays in use),
+	// and the next object created may get the same name
+	void forgetProgram(GLuint program);
+	void forgetVertexArray(GLuint vertexArray);
+	void forgetBuffer(GLuint buffer);
+	void forgetTexture(GLuint texture);
+	void forgetFramebuffer(GLuint framebuffer);
+
+	// Forgets everything, the next change of every kind is made. For a new context, or after GL calls made directly
+	void invalidate();
+
+	// Checks every known value against glGet*, logs each mismatch and fixes the cache. Returns how many there were
+	size_t validate();
+	// Only in builds without NDEBUG, elsewhere it stays off
+	bool validationAvailable();
+	void setValidation(bool enabled);
+	bool validation();
+
+	enum class Kind
+	{
+		Program,
+		VertexArray,
+		Buffer,
+		Texture, // bindings and active unit changes
+		Framebuffer,
+		Capability,
+		Count
+	};
+	const char *kindName(Kind kind);
+
+	struct Counters
+	{
+		size_t issued[static_cast<size_t>(Kind::Count)] = {};
+		size_t skipped[static_cast<size_t>(Kind::Count)] = {};
+		size_t mismatches = 0; // found by validation
+
+		size_t totalIssued() const;
+		size_t totalSkipped() const;
+	};
+	// Since the last resetCounters()
+	const Counters &counters();
+	void resetCounters();
+
+}
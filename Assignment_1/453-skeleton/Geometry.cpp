@@ -7,12 +7,70 @@ GPU_Geometry::GPU_Geometry()
 	: vao()
 	, vertBuffer(0, 3, GL_FLOAT)
 	, colorsBuffer(1, 3, GL_FLOAT)
-{}
+	, ancestorsBuffer(2, 3, GL_FLOAT)
+	, shadesBuffer(3, 1, GL_UNSIGNED_SHORT)
+{
+	ancestorsBuffer.setEnabled(false);
+	shadesBuffer.setEnabled(false);
+}
 
-void GPU_Geometry::setVerts(const std::vector<glm::vec3>& verts) {
+void GPU_Geometry::setVerts(const std::pmr::vector<glm::vec3>& verts) {
 	vertBuffer.uploadData(sizeof(glm::vec3) * verts.size(), verts.data(), GL_STATIC_DRAW);
 }
 
-void GPU_Geometry::setCols(const std::vector<glm::vec3>& cols) {
+void GPU_Geometry::setCols(const std::pmr::vector<glm::vec3>& cols) {
+	vao.bind();
+	colorsBuffer.setEnabled(!cols.empty());
 	colorsBuffer.uploadData(sizeof(glm::vec3) * cols.size(), cols.data(), GL_STATIC_DRAW);
 }
+
+GeometryOutput GPU_Geometry::map(size_t count, bool withAncestors, VertexColors colors) {
+	vao.bind();
+	const bool withCols = colors == VertexColors::PerVertex;
+	const bool withShades = colors == VertexColors::Shades;
+	colorsBuffer.setEnabled(withCols);
+	ancestorsBuffer.setEnabled(withAncestors);
+	shadesBuffer.setEnabled(withShades);
+
+	GLsizeiptr size = sizeof(glm::vec3) * count;
+	GeometryOutput out;
+	out.verts = static_cast<glm::vec3*>(vertBuffer.map(size, GL_STATIC_DRAW));
+	if (withCols) {
+		out.cols = static_cast<glm::vec3*>(colorsBuffer.map(size, GL_STATIC_DRAW));
+	}
+	if (withAncestors) {
+		out.ancestors = static_cast<glm::vec3*>(ancestorsBuffer.map(size, GL_STATIC_DRAW));
+	}
+	if (withShades) {
+		out.shades = static_cast<std::uint16_t*>(shadesBuffer.map(sizeof(std::uint16_t) * count, GL_STATIC_DRAW));
+	}
+	return out;
+}
+
+bool GPU_Geometry::unmap() {
+	// unmapping a buffer that isn't mapped does nothing, so just try all of them
+	bool intact = vertBuffer.unmap();
+	intact = colorsBuffer.unmap() && intact;
+	intact = ancestorsBuffer.unmap() && intact;
+	intact = shadesBuffer.unmap() && intact;
+	return intact;
+}
+
+void GPU_Geometry::captureFeedback(size_t count) {
+	vertBuffer.uploadData(sizeof(glm::vec3) * count, nullptr, GL_STREAM_COPY);
+	colorsBuffer.uploadData(sizeof(glm::vec3) * count, nullptr, GL_STREAM_COPY);
+	vertBuffer.bindFeedback(0);
+	colorsBuffer.bindFeedback(1);
+}
+
+void GPU_Geometry::setShades(const std::pmr::vector<std::uint16_t>& shades) {
+	vao.bind();
+	shadesBuffer.setEnabled(!shades.empty());
+	shadesBuffer.uploadData(sizeof(std::uint16_t) * shades.size(), shades.data(), GL_STATIC_DRAW);
+}
+
+void GPU_Geometry::setAncestors(const std::pmr::vector<glm::vec3>& ancestors) {
+	vao.bind();
+	ancestorsBuffer.setEnabled(!ancestors.empty());
+	ancestorsBuffer.uploadData(sizeof(glm::vec3) * ancestors.size(), ancestors.data(), GL_STATIC_DRAW);
+}
@@ -12,13 +12,53 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 
 
 // List of vertices and texture coordinates using std::vector and glm::vec3
+// The vectors allocate from a memory resource, e.g. a GeometryArena reused across regenerations
 struct CPU_Geometry {
-	std::vector<glm::vec3> verts;
-	std::vector<glm::vec3> cols;
+	explicit CPU_Geometry(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: verts(resource)
+		, cols(resource)
+		, ancestors(resource)
+		, shades(resource)
+	{}
+
+	// Gives the memory of all the vectors back to the resource (clear() keeps it)
+	void release() {
+		std::pmr::vector<glm::vec3>(verts.get_allocator()).swap(verts);
+		std::pmr::vector<glm::vec3>(cols.get_allocator()).swap(cols);
+		std::pmr::vector<glm::vec3>(ancestors.get_allocator()).swap(ancestors);
+		std::pmr::vector<std::uint16_t>(shades.get_allocator()).swap(shades);
+	}
+
+	std::pmr::vector<glm::vec3> verts;
+	std::pmr::vector<glm::vec3> cols; // empty when the shader works out the colours (see VertexColors)
+	std::pmr::vector<glm::vec3> ancestors; // optional, where each vertex was one depth up (for the depth morph)
+	std::pmr::vector<std::uint16_t> shades; // optional, VertexColors::Shades
+};
+
+
+// What the vertices carry so they can be coloured. The built-in fractals' colours are functions
+// of things the generator already knows, so derived_color.vert can work them out on the GPU
+// instead of reading a vec3 per vertex
+enum class VertexColors {
+	PerVertex, // a vec3 colour per vertex (12 bytes)
+	Shades,    // one 16 bit number per vertex the shader turns into a colour: the Levy curve's t, the tree's depth
+	Derived,   // nothing, the shader works it out from the position (the Sierpinski triangle)
+};
+
+
+// Raw destination for generated vertices, either a CPU_Geometry's vectors or a mapped GPU_Geometry.
+// Whoever fills it must only write (mapped GPU memory is very slow to read back)
+struct GeometryOutput {
+	glm::vec3* verts = nullptr;
+	glm::vec3* cols = nullptr; // null when the shader colours the fractal
+	glm::vec3* ancestors = nullptr; // optional (null), where every vertex was one depth up
+	std::uint16_t* shades = nullptr; // optional (null), VertexColors::Shades
 };
 
 
@@ -30,8 +70,25 @@ public:
 	void bind() {
 		vao.bind();
 	}
-	void setVerts(const std::vector<glm::vec3>& verts);
-	void setCols(const std::vector<glm::vec3>& cols);
+	void setVerts(const std::pmr::vector<glm::vec3>& verts);
+	// Both turn their attribute off when given an empty vector, so the colours can come
+	// from either one (or neither) depending on the VertexColors the geometry was made with
+	void setCols(const std::pmr::vector<glm::vec3>& cols);
+	void setShades(const std::pmr::vector<std::uint16_t>& shades);
+	// Second position attribute for the depth morph. Passing an empty vector turns
+	// the attribute off so basic.vert reads a constant instead of an empty buffer
+	void setAncestors(const std::pmr::vector<glm::vec3>& ancestors);
+
+	// Maps the buffers write-only for exactly count vertices, so a generator can write straight into
+	// GPU memory without a CPU_Geometry in between. The ancestors are only mapped withAncestors,
+	// the colours or shades only if colors asks for them.
+	// unmap() before drawing, it returns false if the contents were lost and have to be generated again
+	GeometryOutput map(size_t count, bool withAncestors, VertexColors colors = VertexColors::PerVertex);
+	bool unmap();
+
+	// Sizes the buffers for count vertices and makes them the transform feedback destination,
+	// positions at binding 0 and colours at 1, so a GPU pass can write the geometry instead
+	void captureFeedback(size_t count);
 protected:
 	// note: due to how OpenGL works, vao needs to be
 // defined and initialized before the vertex buffers
@@ -39,6 +96,8 @@ protected:
 
 	VertexBuffer vertBuffer;
 	VertexBuffer colorsBuffer;
+	VertexBuffer ancestorsBuffer;
+	VertexBuffer shadesBuffer; // location 3, off unless the geometry has shades
 private:
 
 };
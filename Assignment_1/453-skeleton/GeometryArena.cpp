@@ -0,0 +1,120 @@
+#include "GeometryArena.h"
+
+#include "Log.h"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+
+namespace {
+	// grow in large steps so a slightly bigger fractal doesn't reallocate the region again
+	const size_t granularity = 1 << 20;
+	const size_t hugePageSize = 2 << 20;
+
+	size_t roundUp(size_t value, size_t multiple) {
+		return (value + multiple - 1) / multiple * multiple;
+	}
+}
+
+
+GeometryArena::GeometryArena(std::pmr::memory_resource* upstream)
+	: upstream(upstream)
+{}
+
+
+GeometryArena::~GeometryArena() {
+	freeRegion();
+}
+
+
+bool GeometryArena::reset() {
+	if (liveAllocations > 0) {
+		return false; // something still points into the region
+	}
+
+	isEnabled = wantEnabled;
+	size_t needed = offset + overflowBytes;
+	if (!isEnabled) {
+		freeRegion();
+	}
+	else if (needed > regionSize || wantHugePages != regionAskedHugePages) {
+		freeRegion();
+		allocateRegion(std::max(needed, regionSize));
+	}
+	offset = 0;
+	overflowBytes = 0;
+	return true;
+}
+
+
+void* GeometryArena::do_allocate(size_t bytes, size_t alignment) {
+	counters.allocations++;
+	liveAllocations++;
+
+	size_t start = roundUp(reinterpret_cast<size_t>(region) + offset, alignment) - reinterpret_cast<size_t>(region);
+	if (isEnabled && region && start + bytes <= regionSize) {
+		offset = start + bytes;
+		return region + start;
+	}
+
+	counters.heapAllocations++;
+	overflowBytes += bytes + alignment;
+	return upstream->allocate(bytes, alignment);
+}
+
+
+void GeometryArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+	liveAllocations--;
+	char* c = static_cast<char*>(p);
+	if (c >= region && c < region + regionSize) {
+		return; // the region is only ever rewound as a whole
+	}
+	upstream->deallocate(p, bytes, alignment);
+}
+
+
+void GeometryArena::allocateRegion(size_t size) {
+	if (size == 0) {
+		return;
+	}
+	counters.regionAllocations++;
+	regionAskedHugePages = wantHugePages;
+
+#if defined(__linux__)
+	// anonymous pages are zero filled on first touch, and madvise asks for 2 MB pages from then on
+	regionSize = roundUp(size, wantHugePages ? hugePageSize : granularity);
+	void* p = mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p == MAP_FAILED) {
+		Log::warning("GeometryArena: could not map {} bytes, using the heap", regionSize);
+		regionSize = 0;
+		return;
+	}
+	region = static_cast<char*>(p);
+	regionHugePages = wantHugePages && madvise(region, regionSize, MADV_HUGEPAGE) == 0;
+	if (wantHugePages && !regionHugePages) {
+		Log::warning("GeometryArena: transparent huge pages are not available");
+	}
+#else
+	regionSize = roundUp(size, granularity);
+	region = static_cast<char*>(upstream->allocate(regionSize, alignof(std::max_align_t)));
+	regionHugePages = false;
+#endif
+}
+
+
+void GeometryArena::freeRegion() {
+	if (!region) {
+		return;
+	}
+#if defined(__linux__)
+	munmap(region, regionSize);
+#else
+	upstream->deallocate(region, regionSize, alignof(std::max_align_t));
+#endif
+	region = nullptr;
+	regionSize = 0;
+	regionHugePages = false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// A memory resource for CPU_Geometry that hands out one region front to back
+// and rewinds it for the next regeneration. Regenerating a fractal (a depth
+// change, a fractal switch, a slider move) frees and reallocates every array,
+// and with the plain heap that means fresh pages (large blocks come straight
+// from mmap and go back on free), a page fault for each of them and a more
+// fragmented heap. The arena keeps its pages and reuses them instead.
+//
+// Anything that doesn't fit goes to the upstream (heap) resource, and the next
+// reset() grows the region to fit the whole cycle. So once the largest fractal
+// has been generated the arena never touches the heap again.
+//------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <memory_resource>
+
+
+class GeometryArena : public std::pmr::memory_resource
+{
+public:
+	struct Stats
+	{
+		size_t allocations = 0;		  // every request, arena or heap
+		size_t heapAllocations = 0;	  // requests that went to the upstream resource (overflow, or the arena is off)
+		size_t regionAllocations = 0; // times the region itself was (re)allocated
+	};
+
+	explicit GeometryArena(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+	~GeometryArena() override;
+
+	// The region is a raw block of memory, it can't be shared between two arenas
+	GeometryArena(const GeometryArena &) = delete;
+	GeometryArena &operator=(const GeometryArena &) = delete;
+
+	// Rewinds the region for the next cycle, and grows it (or reallocates it for a huge page change)
+	// if needed. Everything allocated must have been deallocated first, otherwise it does nothing
+	// and returns false
+	bool reset();
+
+	// Off, every request goes to the upstream resource (for comparing against the plain heap)
+	void setEnabled(bool enabled) { wantEnabled = enabled; }
+	// Backs the region with transparent huge pages (Linux only). Both settings apply at the next reset()
+	void setHugePages(bool hugePages) { wantHugePages = hugePages; }
+
+	bool enabled() const { return isEnabled; }
+	bool hugePages() const { return regionHugePages; }
+	size_t capacity() const { return regionSize; }
+	size_t used() const { return offset; }
+	const Stats &stats() const { return counters; }
+	void resetStats() { counters = Stats(); }
+
+protected:
+	void *do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+	void allocateRegion(size_t size);
+	void freeRegion();
+
+	std::pmr::memory_resource *upstream;
+
+	char *region = nullptr;
+	size_t regionSize = 0;
+	bool regionHugePages = false;	  // what the region got
+	bool regionAskedHugePages = false; // what it was allocated with, huge pages may be unavailable
+	size_t offset = 0;		   // the next free byte of the region
+	size_t overflowBytes = 0;  // what didn't fit this cycle
+	size_t liveAllocations = 0;
+
+	bool isEnabled = true;
+	bool wantEnabled = true;
+	bool wantHugePages = false;
+
+	Stats counters;
+};
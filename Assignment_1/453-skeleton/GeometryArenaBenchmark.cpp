@@ -0,0 +1,63 @@
+#include "GeometryArenaBenchmark.h"
+
+#include "GeometryArena.h"
+#include "Log.h"
+#include "MemoryStats.h"
+
+#include <chrono>
+
+
+RegenerationCost measureDepthChanges(const DepthChangeWorkload &workload, bool useArena, bool hugePages, int rounds)
+{
+	GeometryArena arena;
+	arena.setEnabled(useArena);
+	arena.setHugePages(hugePages);
+	CPU_Geometry geom(&arena);
+
+	size_t faultsStart = MemoryStats::pageFaults();
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+	{
+		for (int fractal = 0; fractal < 3; fractal++)
+		{
+			for (int depth = 0; depth <= workload.maxDepth[fractal]; depth++)
+			{
+				geom.release();
+				arena.reset();
+				switch (fractal)
+				{
+				case 0:
+					generateSierpinskiTriangle(geom, depth);
+					break;
+				case 1:
+					generateLevyCurve(geom, depth);
+					break;
+				case 2:
+					generateTree(geom, depth, workload.treeParams);
+					break;
+				}
+				// triangles for the Sierpinski triangle, lines for the others
+				reorderPrimitives(geom, fractal == 0 ? 3 : 2, workload.order);
+			}
+		}
+	}
+
+	RegenerationCost cost;
+	cost.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	cost.pageFaults = MemoryStats::pageFaults() - faultsStart;
+	cost.allocations = arena.stats().allocations;
+	cost.heapAllocations = arena.stats().heapAllocations;
+	return cost;
+}
+
+void reportDepthChangeBenchmark(const DepthChangeWorkload &workload, bool hugePages)
+{
+	const int rounds = 20;
+	RegenerationCost heap = measureDepthChanges(workload, false, false, rounds);
+	RegenerationCost arena = measureDepthChanges(workload, true, hugePages, rounds);
+	Log::info("DEPTH_BENCHMARK {} rounds over every fractal and depth, {} order", rounds, workload.orderName);
+	Log::info("DEPTH_BENCHMARK heap:  {:.1f} ms, {} allocations, {} from the heap, {} page faults",
+			  heap.ms, heap.allocations, heap.heapAllocations, heap.pageFaults);
+	Log::info("DEPTH_BENCHMARK arena: {:.1f} ms, {} allocations, {} from the heap, {} page faults{}",
+			  arena.ms, arena.allocations, arena.heapAllocations, arena.pageFaults, hugePages ? " (huge pages)" : "");
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// What the geometry arena saves on depth changes. Every fractal is stepped
+// through every depth a number of times, regenerating (and reordering) into a
+// CPU_Geometry the way the window does, and the heap allocations and page
+// faults it took are counted. Run once on the plain heap and once with an
+// arena, the difference is what the arena saves.
+//------------------------------------------------------------------------------
+
+#include "Fractals.h"
+#include "PrimitiveOrder.h"
+
+#include <cstddef>
+
+
+struct RegenerationCost
+{
+	double ms = 0.0;
+	size_t allocations = 0;
+	size_t heapAllocations = 0;
+	size_t pageFaults = 0;
+};
+
+// The regenerations to repeat: the deepest depth of every fractal (Sierpinski, Levy, tree), the
+// tree's shape and the primitive order, the window's current settings
+struct DepthChangeWorkload
+{
+	int maxDepth[3] = {};
+	TreeParams treeParams;
+	CurveType order = CurveType::Recursion;
+	const char *orderName = ""; // for the log
+};
+
+// Every fractal through every depth, rounds times, into a geometry using its own arena
+// (so the live geometry isn't disturbed). useArena = false allocates from the heap instead
+RegenerationCost measureDepthChanges(const DepthChangeWorkload &workload, bool useArena, bool hugePages, int rounds);
+
+// Measures the heap and then the arena, and logs both
+void reportDepthChangeBenchmark(const DepthChangeWorkload &workload, bool hugePages);
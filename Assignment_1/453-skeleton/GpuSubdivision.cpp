@@ -0,0 +1,54 @@
+#include "GpuSubdivision.h"
+
+#include "AssetPath.h"
+#include "GLState.h"
+
+
+GpuSubdivision::GpuSubdivision()
+	: triangleProgram(
+		AssetPath::Instance()->Get("shaders/subdivide.vert"),
+		AssetPath::Instance()->Get("shaders/subdivide_triangles.geom"),
+		AssetPath::Instance()->Get("shaders/basic.frag"),
+		{"outPos", "fragColor"})
+	, lineProgram(
+		AssetPath::Instance()->Get("shaders/subdivide.vert"),
+		AssetPath::Instance()->Get("shaders/subdivide_lines.geom"),
+		AssetPath::Instance()->Get("shaders/basic.frag"),
+		{"outPos", "fragColor"})
+	, current(0)
+	, count(0)
+{}
+
+
+void GpuSubdivision::run(const CPU_Geometry &coarse, GLenum mode, int levels)
+{
+	current = 0;
+	count = static_cast<GLsizei>(coarse.verts.size());
+	sides[current].setVerts(coarse.verts);
+	sides[current].setCols(coarse.cols);
+
+	// every primitive becomes three triangles or two segments
+	const GLsizei arity = (mode == GL_TRIANGLES) ? 3 : 2;
+	(mode == GL_TRIANGLES ? triangleProgram : lineProgram).use();
+	GLState::enable(GL_RASTERIZER_DISCARD); // nothing is drawn, the passes only write buffers
+	for (int level = 0; level < levels; level++)
+	{
+		const int next = 1 - current;
+		sides[next].captureFeedback(static_cast<size_t>(count) * arity);
+		sides[current].bind();
+		glBeginTransformFeedback(mode);
+		glDrawArrays(mode, 0, count);
+		glEndTransformFeedback();
+
+		current = next;
+		count *= arity;
+	}
+	GLState::disable(GL_RASTERIZER_DISCARD);
+}
+
+
+void GpuSubdivision::draw(GLenum mode)
+{
+	sides[current].bind();
+	glDrawArrays(mode, 0, count);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// Does the last few levels of the Sierpinski triangle or the Levy curve on the
+// GPU. The CPU generates and uploads a coarser depth, then a geometry shader that
+// subdivides every primitive once runs that many times, each pass capturing its
+// output with transform feedback into the other of two buffers (ping-pong).
+// Children come out right after their parent, so the result is in the same
+// order as the CPU recursion.
+//
+// Only fractals that are pure subdivision work this way, the tree keeps its
+// older branches and grows new ones, so it isn't handled here.
+//------------------------------------------------------------------------------
+
+#include "Geometry.h"
+#include "ShaderProgram.h"
+
+#include <glad/glad.h>
+
+
+class GpuSubdivision {
+public:
+	GpuSubdivision();
+
+	// Uploads the coarse geometry (GL_TRIANGLES for the Sierpinski triangle, GL_LINES for the
+	// Levy curve) and subdivides it `levels` times
+	void run(const CPU_Geometry &coarse, GLenum mode, int levels);
+	void draw(GLenum mode);
+
+	GLsizei vertexCount() const { return count; }
+
+private:
+	ShaderProgram triangleProgram;
+	ShaderProgram lineProgram;
+
+	GPU_Geometry sides[2];
+	int current;   // which side holds the result
+	GLsizei count; // vertices in it
+};
@@ -0,0 +1,31 @@
+#include "GpuTimer.h"
+
+
+GpuTimer::GpuTimer()
+	: queries{}
+	, pending{ false, false }
+	, current(0)
+	, ms(0.0)
+{}
+
+
+void GpuTimer::begin() {
+	if (pending[current]) {
+		GLint available = 0;
+		glGetQueryObjectiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &nanoseconds);
+			ms = nanoseconds / 1.0e6;
+		}
+		pending[current] = false;
+	}
+	glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+
+void GpuTimer::end() {
+	glEndQuery(GL_TIME_ELAPSED);
+	pending[current] = true;
+	current = 1 - current;
+}
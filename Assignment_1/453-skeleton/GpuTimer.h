@@ -0,0 +1,27 @@
+#pragma once
+
+#include "GLHandles.h"
+
+#include <glad/glad.h>
+
+// Times a span of GPU commands with GL_TIME_ELAPSED queries.
+//
+// Waiting for a query result would stall the CPU until the GPU catches up, so two
+// queries are used in turn and each result is only read back once it is available
+// (usually one frame later).
+class GpuTimer {
+
+public:
+	GpuTimer();
+
+	// Public interface
+	void begin();
+	void end();
+	double lastMs() const { return ms; }
+
+private:
+	QueryHandle queries[2];
+	bool pending[2];
+	int current;
+	double ms;
+};
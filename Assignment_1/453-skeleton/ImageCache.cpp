@@ -0,0 +1,51 @@
+#include "ImageCache.h"
+
+#include "GLState.h"
+
+
+// GL_SRGB when the window's back buffer encodes to sRGB (with GL_FRAMEBUFFER_SRGB on), so the
+// target stores what the window would have. Needs the window's framebuffer bound
+static GLenum windowColorFormat() {
+	GLint encoding = GL_LINEAR;
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT, GL_FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING, &encoding);
+	return encoding == GL_SRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+}
+
+
+ImageCache::ImageCache()
+	: target(windowColorFormat(), GL_NEAREST) // only ever blitted 1:1
+	, viewport(0)
+	, isValid(false)
+	, captureCount(0)
+{}
+
+
+void ImageCache::beginCapture() {
+	glGetIntegerv(GL_VIEWPORT, &viewport.x);
+	target.resize(glm::max(glm::ivec2(viewport.z, viewport.w), glm::ivec2(1))); // minimised windows are 0x0
+	target.bind();
+	glViewport(0, 0, viewport.z, viewport.w);
+	glClear(GL_COLOR_BUFFER_BIT);
+}
+
+
+void ImageCache::endCapture() {
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+	isValid = true;
+	captureCount++;
+}
+
+
+void ImageCache::blit() const {
+	const bool srgb = GLState::isEnabled(GL_FRAMEBUFFER_SRGB);
+	GLState::disable(GL_FRAMEBUFFER_SRGB); // a plain copy, the target is already encoded like the window
+	GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer());
+	GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, viewport.z, viewport.w, viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w,
+					  GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (srgb) {
+		GLState::enable(GL_FRAMEBUFFER_SRGB);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Framebuffer.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// The fractal pass drawn once into an offscreen target, and copied onto the window with one blit for
+// as long as nothing it was drawn from changes. An unchanged frame then costs a copy of its pixels,
+// however many primitives the fractal has. Deciding when it changed is up to the caller.
+//
+// The target gets the window's colour encoding (sRGB or linear) and the blit runs with
+// GL_FRAMEBUFFER_SRGB off, so the window gets exactly the bits the pass would have written to it
+class ImageCache {
+
+public:
+	ImageCache();
+	// Rule of zero, the framebuffer cleans up after itself
+
+	// Public interface
+	// Redirects drawing into the target, sized to the current viewport, and clears it
+	void beginCapture();
+	// Back to the window, the image is valid from here on
+	void endCapture();
+	// Copies the image onto the window where the viewport was when it was captured
+	void blit() const;
+
+	bool valid() const { return isValid; }
+	void invalidate() { isValid = false; }
+	size_t captures() const { return captureCount; }
+
+private:
+	Framebuffer target;
+	glm::ivec4 viewport;
+	bool isValid;
+	size_t captureCount;
+};
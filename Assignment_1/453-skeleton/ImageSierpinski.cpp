@@ -0,0 +1,77 @@
+#include "ImageSierpinski.h"
+
+#include "AssetPath.h"
+#include "GLState.h"
+
+
+// the stages of image_space.vert/.frag
+enum ImageStage
+{
+	Seed, // the depth 0 triangle
+	Copy, // three half-scale copies of the last image
+	Show  // the last image, unscaled
+};
+
+
+ImageSierpinski::ImageSierpinski()
+	: program(
+		AssetPath::Instance()->Get("shaders/image_space.vert"),
+		AssetPath::Instance()->Get("shaders/image_space.frag"))
+	, targets{Framebuffer(GL_RGBA8, GL_NEAREST), Framebuffer(GL_RGBA8, GL_NEAREST)} // read with texelFetch, never filtered
+	, current(0)
+	, lastPasses(0)
+{}
+
+
+void ImageSierpinski::render(int depth)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	const GLuint previous = GLState::drawFramebuffer(); // the window, or the retained image's target (see ImageCache.h)
+	const glm::ivec2 size(viewport[2], viewport[3]);
+	if (size.x <= 0 || size.y <= 0)
+	{ // minimised
+		return;
+	}
+
+	program.use();
+	emptyVao.bind();
+	glUniform1i(glGetUniformLocation(program, "image"), 0);
+	glViewport(0, 0, size.x, size.y);
+
+	// depth 0 straight into the first target, the fragment shader keeps what is inside the triangle
+	current = 0;
+	targets[current].resize(size);
+	targets[current].bind();
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f); // alpha 0 is empty
+	glClear(GL_COLOR_BUFFER_BIT);
+	glUniform1i(glGetUniformLocation(program, "stage"), Seed);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	glUniform1i(glGetUniformLocation(program, "stage"), Copy);
+	for (int level = 0; level < depth; level++)
+	{
+		const int next = 1 - current;
+		targets[next].resize(size);
+		targets[next].bind();
+		glClear(GL_COLOR_BUFFER_BIT);
+		targets[current].bindTexture(0);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 3); // one instance per copy
+		current = next;
+	}
+	lastPasses = depth + 1;
+
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, previous);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+
+void ImageSierpinski::draw()
+{
+	program.use();
+	emptyVao.bind();
+	targets[current].bindTexture(0);
+	glUniform1i(glGetUniformLocation(program, "image"), 0);
+	glUniform1i(glGetUniformLocation(program, "stage"), Show);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// The Sierpinski triangle rendered in image space. The depth k+1 triangle is
+// exactly three half-scale copies of the depth k one (x -> (x + corner) / 2 for
+// each corner of the root triangle), so instead of drawing 3^depth triangles
+// the image is built in depth passes: each pass draws the last image three times,
+// scaled, into the other of two framebuffers. Every pass covers 3/4 of the image,
+// whatever the depth.
+//
+// The image holds the final colours. A triangle is coloured by its first corner,
+// which moves with the copy the same way, so a pass only halves and offsets them.
+//------------------------------------------------------------------------------
+
+#include "Framebuffer.h"
+#include "ShaderProgram.h"
+#include "VertexArray.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+
+class ImageSierpinski {
+public:
+	ImageSierpinski();
+
+	// Builds the image of the given depth at the size of the current viewport.
+	// Leaves the default framebuffer bound, with the viewport as it was
+	void render(int depth);
+	// Draws the last image over the current framebuffer (transparent where nothing is)
+	void draw();
+
+	int passes() const { return lastPasses; }
+
+private:
+	ShaderProgram program;
+	VertexArray emptyVao; // the quads come from gl_VertexID
+
+	Framebuffer targets[2];
+	int current; // the target holding the last image
+	int lastPasses;
+};
@@ -0,0 +1,64 @@
+#include "ImageSierpinskiBenchmark.h"
+
+#include "Fractals.h"
+#include "Geometry.h"
+#include "Log.h"
+
+#include <chrono>
+
+
+void reportImageSpaceBenchmark(ImageSierpinski &image, ShaderProgram &shader, int maxDepth)
+{
+	const int firstDepth = 6;
+	const int geometryMaxDepth = 13; // 4.8 million vertices, 115 MB on the CPU and again on the GPU
+	const int runs = 10;
+	auto msSince = [](std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	CPU_Geometry cpuGeom;
+	GPU_Geometry gpuGeom;
+	for (int depth = firstDepth; depth <= maxDepth; depth++)
+	{
+		image.render(depth); // warm up, and sizes the targets
+		glFinish();
+		auto imageStart = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; run++)
+		{
+			image.render(depth);
+			image.draw();
+		}
+		glFinish();
+		const double imageMs = msSince(imageStart) / runs;
+
+		const size_t vertices = sierpinskiVertexCount(depth);
+		if (depth > geometryMaxDepth)
+		{
+			Log::info("IMAGE_BENCHMARK depth {}: image {:.3f} ms ({} passes), geometry skipped ({} vertices, {:.0f} MB)",
+					  depth, imageMs, image.passes(), vertices, vertices * 2 * sizeof(glm::vec3) / 1048576.0);
+			continue;
+		}
+
+		auto generateStart = std::chrono::steady_clock::now();
+		generateSierpinskiTriangle(cpuGeom, depth);
+		gpuGeom.setVerts(cpuGeom.verts);
+		gpuGeom.setCols(cpuGeom.cols);
+		glFinish();
+		const double uploadMs = msSince(generateStart);
+
+		shader.use();
+		gpuGeom.bind();
+		glUniform1f(glGetUniformLocation(shader, "morph"), 1.0f);
+		auto drawStart = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; run++)
+		{
+			glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices));
+		}
+		glFinish();
+		const double drawMs = msSince(drawStart) / runs;
+
+		Log::info("IMAGE_BENCHMARK depth {}: image {:.3f} ms ({} passes), geometry draw {:.3f} ms + generate and upload {:.1f} ms ({} vertices)",
+				  depth, imageMs, image.passes(), drawMs, uploadMs, vertices);
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// The image space Sierpinski against the geometry path (generate, upload, draw)
+// at depths 6 to maxDepth, waiting for the GPU around every step. The geometry
+// path stops at depth 13, where its vertices get too big. Logs one line per depth.
+//------------------------------------------------------------------------------
+
+#include "ImageSierpinski.h"
+#include "ShaderProgram.h"
+
+
+// shader is basic.vert/.frag, for the triangles. Draws into the current framebuffer
+void reportImageSpaceBenchmark(ImageSierpinski &image, ShaderProgram &shader, int maxDepth);
@@ -0,0 +1,49 @@
+#include "InstancedSierpinski.h"
+
+#include "Fractals.h"
+
+#include <chrono>
+
+
+InstancedSierpinski::InstancedSierpinski()
+	: vao()
+	, baseBuffer(0, 3, GL_FLOAT)
+	, instanceBuffer(1, 3, GL_FLOAT, 1)
+	, depth(-1)
+	, lastGenerateMs(0.0)
+	, lastUploadMs(0.0)
+{
+	// the corners of the root triangle in generateSierpinskiTriangle, relative to the first one
+	const glm::vec3 base[3] = {
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(1.0f, 0.0f, 0.0f),
+		glm::vec3(0.5f, 1.0f, 0.0f)};
+	baseBuffer.uploadData(sizeof(base), base, GL_STATIC_DRAW);
+}
+
+
+void InstancedSierpinski::update(int newDepth)
+{
+	if (newDepth == depth)
+	{
+		return;
+	}
+	depth = newDepth;
+
+	auto generateStart = std::chrono::steady_clock::now();
+	instances.resize(sierpinskiInstanceCount(depth));
+	generateSierpinskiInstances(instances.data(), depth);
+	auto uploadStart = std::chrono::steady_clock::now();
+	instanceBuffer.uploadData(sizeof(glm::vec3) * instances.size(), instances.data(), GL_STATIC_DRAW);
+	auto uploadEnd = std::chrono::steady_clock::now();
+
+	lastGenerateMs = std::chrono::duration<double, std::milli>(uploadStart - generateStart).count();
+	lastUploadMs = std::chrono::duration<double, std::milli>(uploadEnd - uploadStart).count();
+}
+
+
+void InstancedSierpinski::draw()
+{
+	vao.bind();
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 3, static_cast<GLsizei>(instances.size()));
+}
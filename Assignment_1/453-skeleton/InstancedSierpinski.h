@@ -0,0 +1,44 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// The Sierpinski triangle drawn with instancing. Every leaf triangle is the root
+// triangle at the same scale, so one base triangle is uploaded once and each leaf
+// only needs its first corner and scale (12 bytes instead of 72 for three
+// positions and three colours). The colour is worked out in the shader.
+//------------------------------------------------------------------------------
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+class InstancedSierpinski {
+public:
+	InstancedSierpinski();
+
+	// Regenerates and uploads the instances, only if the depth changed
+	void update(int depth);
+	void draw();
+
+	int instanceCount() const { return static_cast<int>(instances.size()); }
+	size_t uploadBytes() const { return sizeof(glm::vec3) * instances.size(); } // of the last update
+	double generateMs() const { return lastGenerateMs; }
+	double uploadMs() const { return lastUploadMs; }
+
+private:
+	// note: due to how OpenGL works, vao needs to be
+	// defined and initialized before the vertex buffers
+	VertexArray vao;
+
+	VertexBuffer baseBuffer;	 // the root triangle with its first corner moved to the origin, scale 1
+	VertexBuffer instanceBuffer; // per instance: xy is the leaf's first corner, z its scale
+
+	std::vector<glm::vec3> instances;
+	int depth;
+	double lastGenerateMs;
+	double lastUploadMs;
+};
@@ -0,0 +1,118 @@
+#include "MemoryStats.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <string>
+#endif
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+
+namespace {
+
+#if defined(__linux__)
+	// /proc/self/status and /proc/meminfo list their numbers in kB, e.g. "VmHWM:	   12345 kB"
+	size_t procField(const char* path, const char* field) {
+		std::ifstream file(path);
+		std::string line;
+		const std::string prefix = std::string(field) + ":";
+		while (std::getline(file, line)) {
+			if (line.compare(0, prefix.size(), prefix) == 0) {
+				return std::stoull(line.substr(prefix.size())) * 1024;
+			}
+		}
+		return 0;
+	}
+#endif
+
+}
+
+
+size_t MemoryStats::currentRss() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+#elif defined(__linux__)
+	return procField("/proc/self/status", "VmRSS");
+#else
+	return 0;
+#endif
+}
+
+
+size_t MemoryStats::peakRss() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#elif defined(__linux__)
+	return procField("/proc/self/status", "VmHWM");
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return static_cast<size_t>(usage.ru_maxrss); // already bytes on macOS
+#endif
+}
+
+
+size_t MemoryStats::pageFaults() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PageFaultCount : 0;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+	return static_cast<size_t>(usage.ru_minflt + usage.ru_majflt);
+#endif
+}
+
+
+double MemoryStats::cpuSeconds() {
+#if defined(_WIN32)
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+		return 0.0;
+	}
+	auto seconds = [](const FILETIME &time) { // in 100 ns ticks
+		return ((static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7;
+	};
+	return seconds(kernel) + seconds(user);
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0.0;
+	}
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+
+size_t MemoryStats::availableMemory() {
+#if defined(_WIN32)
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	return GlobalMemoryStatusEx(&status) ? static_cast<size_t>(status.ullAvailPhys) : 0;
+#elif defined(__linux__)
+	return procField("/proc/meminfo", "MemAvailable");
+#else
+	return 0;
+#endif
+}
+
+
+void MemoryStats::resetPeak() {
+#if defined(__linux__)
+	// writing 5 here resets VmHWM to the current RSS (Linux 4.0 and later)
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+#endif
+}
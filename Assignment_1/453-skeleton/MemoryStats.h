@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+// Resident memory of this process, for comparing how much the generate/upload paths keep around.
+// All sizes are in bytes, and 0 where the platform doesn't tell us.
+namespace MemoryStats {
+
+	size_t currentRss();
+	// High-water mark of the resident set since the process started (or since resetPeak())
+	size_t peakRss();
+	// Starts a new high-water mark (Linux only, elsewhere the peak keeps counting from startup)
+	void resetPeak();
+
+	// Page faults (minor and major) taken by the process so far, a count rather than bytes.
+	// Touching freshly allocated memory faults once per page, reused memory doesn't
+	size_t pageFaults();
+
+	// CPU time (user and system, all threads) the process has used so far, in seconds, not a size either.
+	// Its growth over a second of wall time is how busy the process is
+	double cpuSeconds();
+
+	// Physical memory the system could still hand out without swapping (MemAvailable on Linux).
+	// Linux overcommits, so an allocation bigger than this succeeds and the process is killed later
+	size_t availableMemory();
+
+}
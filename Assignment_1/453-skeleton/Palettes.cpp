@@ -0,0 +1,93 @@
+#include "Palettes.h"
+
+#include "GLState.h"
+
+#include <glm/glm.hpp>
+
+// only the preset stops, the rest of vivid (ColorMap itself) isn't compiled into the skeleton
+#include <vivid/data/blue-yellow.h>
+#include <vivid/data/cool-warm.h>
+#include <vivid/data/hsl-pastel.h>
+#include <vivid/data/hsl.h>
+#include <vivid/data/inferno.h>
+#include <vivid/data/magma.h>
+#include <vivid/data/plasma.h>
+#include <vivid/data/rainbow.h>
+#include <vivid/data/turbo.h>
+#include <vivid/data/viridis.h>
+#include <vivid/data/vivid.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+	struct Preset {
+		const char* name;
+		const std::vector<vivid::srgb_t>& stops;
+	};
+
+	// in the order of the layers
+	const Preset presets[] = {
+		{"Viridis", vivid::data::viridis},
+		{"Inferno", vivid::data::inferno},
+		{"Magma", vivid::data::magma},
+		{"Plasma", vivid::data::plasma},
+		{"Turbo", vivid::data::turbo},
+		{"Cool Warm", vivid::data::cool_warm},
+		{"Blue Yellow", vivid::data::blue_yellow},
+		{"Rainbow", vivid::data::rainbow},
+		{"HSL", vivid::data::hsl},
+		{"HSL Pastel", vivid::data::hsl_pastel},
+		{"Vivid", vivid::data::vivid},
+	};
+
+	// what vivid::ColorMap::at does with linear interpolation
+	glm::vec3 sample(const std::vector<vivid::srgb_t>& stops, float t) {
+		const float position = glm::clamp(t, 0.f, 1.f) * (stops.size() - 1);
+		const size_t k = static_cast<size_t>(position);
+		if (k + 1 >= stops.size()) {
+			return stops.back();
+		}
+		return glm::mix(glm::vec3(stops[k]), glm::vec3(stops[k + 1]), position - k);
+	}
+}
+
+
+Palettes::Palettes()
+	: texture()
+{
+	std::vector<std::uint8_t> texels;
+	texels.reserve(3 * entries * count());
+	for (const Preset& preset : presets) {
+		for (int i = 0; i < entries; i++) {
+			glm::vec3 color = sample(preset.stops, i / float(entries - 1));
+			for (int c = 0; c < 3; c++) {
+				texels.push_back(static_cast<std::uint8_t>(std::lround(glm::clamp(color[c], 0.f, 1.f) * 255.f)));
+			}
+		}
+	}
+
+	GLState::bindTexture(GL_TEXTURE_1D_ARRAY, texture);
+	glTexImage2D(GL_TEXTURE_1D_ARRAY, 0, GL_SRGB8, entries, count(), 0, GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+	glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0); // no mipmaps
+	GLState::bindTexture(GL_TEXTURE_1D_ARRAY, 0);
+}
+
+
+int Palettes::count() {
+	return static_cast<int>(sizeof(presets) / sizeof(presets[0]));
+}
+
+
+const char* Palettes::name(int palette) {
+	return presets[palette].name;
+}
+
+
+void Palettes::bind(GLuint unit) const {
+	GLState::bindTexture(unit, GL_TEXTURE_1D_ARRAY, texture);
+}
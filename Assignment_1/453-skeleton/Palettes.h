@@ -0,0 +1,28 @@
+#pragma once
+
+#include "GLHandles.h"
+
+#include <glad/glad.h>
+
+// vivid's colour map presets (viridis, inferno, turbo, ...) baked into one GL_TEXTURE_1D_ARRAY,
+// one layer per preset. A shader colours by a scalar in [0, 1] and picks the layer with a
+// uniform, so switching palettes changes no geometry at all.
+//
+// The entries are sRGB (GL_SRGB8), the GPU decodes them when sampling and the sRGB framebuffer
+// encodes them again, so the palettes show exactly as vivid defines them.
+class Palettes {
+
+public:
+	static constexpr int entries = 256; // per palette, resampled from the preset's stops
+
+	Palettes();
+
+	// Public interface
+	static int count();
+	static const char* name(int palette);
+
+	void bind(GLuint unit) const;
+
+private:
+	TextureHandle texture;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// Plain std::thread helpers for the CPU passes over generated geometry
+// (reordering, deduplication)
+//------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+
+// Runs fn(begin, end, threadIndex) over [0, count) split into one chunk per thread
+inline void parallelFor(size_t count, int threads, const std::function<void(size_t, size_t, int)> &fn)
+{
+	if (threads <= 1 || count < 4096)
+	{ // not worth starting threads for
+		fn(0, count, 0);
+		return;
+	}
+	std::vector<std::thread> workers;
+	size_t chunk = (count + threads - 1) / threads;
+	for (int t = 0; t < threads; t++)
+	{
+		size_t begin = std::min(count, t * chunk);
+		size_t end = std::min(count, begin + chunk);
+		workers.emplace_back(fn, begin, end, t);
+	}
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+// threads = 0 means every hardware thread
+inline int threadCount(int threads)
+{
+	return threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
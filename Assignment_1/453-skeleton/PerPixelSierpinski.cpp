@@ -0,0 +1,101 @@
+#include "PerPixelSierpinski.h"
+
+#include "Fractals.h"
+#include "Framebuffer.h"
+#include "Geometry.h"
+#include "GLState.h"
+#include "Log.h"
+
+#include <chrono>
+#include <vector>
+
+
+void drawPerPixelSierpinski(ShaderProgram &program, const VertexArray &emptyVao, int depth, glm::vec2 centre, float zoom)
+{
+	program.use();
+	emptyVao.bind();
+	glUniform1i(glGetUniformLocation(program, "depth"), depth);
+	glUniform2f(glGetUniformLocation(program, "centre"), centre.x, centre.y);
+	glUniform1f(glGetUniformLocation(program, "zoom"), zoom);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void reportPerPixelBenchmark(ShaderProgram &pixelShader, const VertexArray &emptyVao, ShaderProgram &shader, int maxDepth)
+{
+	const int geometryMaxDepth = 13;
+	const int runs = 10;
+	auto msSince = [](std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	const glm::ivec2 size(viewport[2], viewport[3]);
+	Framebuffer pixelTarget(GL_RGBA8, GL_NEAREST);
+	Framebuffer geometryTarget(GL_RGBA8, GL_NEAREST);
+	pixelTarget.resize(size);
+	geometryTarget.resize(size);
+	glViewport(0, 0, size.x, size.y);
+	std::vector<glm::u8vec4> pixelImage(size.x * size.y);
+	std::vector<glm::u8vec4> geometryImage(size.x * size.y);
+
+	CPU_Geometry cpuGeom;
+	GPU_Geometry gpuGeom;
+	for (int depth = 0; depth <= maxDepth; depth++)
+	{
+		pixelTarget.bind();
+		glClear(GL_COLOR_BUFFER_BIT);
+		glFinish();
+		auto pixelStart = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; run++)
+		{
+			drawPerPixelSierpinski(pixelShader, emptyVao, depth, glm::vec2(0.0f), 1.0f);
+		}
+		glFinish();
+		const double pixelMs = msSince(pixelStart) / runs;
+		if (depth > geometryMaxDepth)
+		{
+			Log::info("PIXEL_BENCHMARK depth {}: per pixel {:.3f} ms", depth, pixelMs);
+			continue;
+		}
+		glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixelImage.data());
+
+		generateSierpinskiTriangle(cpuGeom, depth);
+		gpuGeom.setVerts(cpuGeom.verts);
+		gpuGeom.setCols(cpuGeom.cols);
+		geometryTarget.bind();
+		glClear(GL_COLOR_BUFFER_BIT);
+		shader.use();
+		gpuGeom.bind();
+		glUniform1f(glGetUniformLocation(shader, "morph"), 1.0f);
+		glFinish();
+		auto geometryStart = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; run++)
+		{
+			glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(cpuGeom.verts.size()));
+		}
+		glFinish();
+		const double geometryMs = msSince(geometryStart) / runs;
+		glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, geometryImage.data());
+
+		size_t coverage = 0;
+		size_t colour = 0;
+		for (size_t i = 0; i < pixelImage.size(); i++)
+		{
+			if ((pixelImage[i].a == 0) != (geometryImage[i].a == 0))
+			{
+				coverage++;
+			}
+			else if (glm::any(glm::greaterThan(glm::abs(glm::ivec4(pixelImage[i]) - glm::ivec4(geometryImage[i])), glm::ivec4(1))))
+			{
+				colour++;
+			}
+		}
+		Log::info("PIXEL_BENCHMARK depth {}: per pixel {:.3f} ms, triangles {:.3f} ms, {} pixels differ in coverage and {} in colour",
+				  depth, pixelMs, geometryMs, coverage, colour);
+	}
+
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
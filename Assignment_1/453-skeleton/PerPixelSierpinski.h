@@ -0,0 +1,22 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// The Sierpinski triangle decided pixel by pixel: one full-screen triangle, and
+// sierpinski_pixel.frag tests every pixel for membership on its own (see the
+// shader). The cost per pixel doesn't depend on the depth.
+//------------------------------------------------------------------------------
+
+#include "ShaderProgram.h"
+#include "VertexArray.h"
+
+#include <glm/glm.hpp>
+
+
+// program is fullscreen.vert + sierpinski_pixel.frag. centre (in the fractal's coordinates) and zoom pan and zoom the view
+void drawPerPixelSierpinski(ShaderProgram &program, const VertexArray &emptyVao, int depth, glm::vec2 centre, float zoom);
+
+// Renders the per pixel Sierpinski and the uploaded triangles (shader, basic.vert/.frag) into two
+// offscreen targets the size of the viewport, for depths 0 to maxDepth. Reads both back and logs the
+// pixels that differ (coverage, or a colour off by more than rounding), plus the time of each.
+// The triangles stop at depth 13 like the image space benchmark
+void reportPerPixelBenchmark(ShaderProgram &pixelShader, const VertexArray &emptyVao, ShaderProgram &shader, int maxDepth);
@@ -0,0 +1,170 @@
+#include "PickIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+void PickIndex::build(const CPU_Geometry &geom, int vertsPerPrimitive_, int arity_, int depth, bool innerPrimitives)
+{
+	arity = arity_;
+	vertsPerPrimitive = vertsPerPrimitive_;
+	nodes.clear();
+	const size_t primitives = geom.verts.size() / vertsPerPrimitive;
+	bufferIndex.resize(primitives);
+	for (size_t i = 0; i < primitives; i++)
+	{
+		bufferIndex[i] = static_cast<uint32_t>(i);
+	}
+	if (primitives == 0)
+	{
+		return;
+	}
+
+	int32_t nextPrimitive = 0; // primitives come out of the recursion in depth first order
+	auto primitiveBox = [&](Node &node)
+	{
+		node.primitive = nextPrimitive++;
+		node.lo = glm::vec2(geom.verts[node.primitive * vertsPerPrimitive]);
+		node.hi = node.lo;
+		for (int v = 1; v < vertsPerPrimitive; v++)
+		{
+			node.lo = glm::min(node.lo, glm::vec2(geom.verts[node.primitive * vertsPerPrimitive + v]));
+			node.hi = glm::max(node.hi, glm::vec2(geom.verts[node.primitive * vertsPerPrimitive + v]));
+		}
+	};
+
+	// the same recursion as the generator. Nodes are referred to by index, the vector grows as we go
+	auto fill = [&](auto &&self, uint32_t index, int level) -> void
+	{
+		nodes[index].primitive = -1;
+		nodes[index].firstChild = 0;
+		if (innerPrimitives || level == depth)
+		{
+			primitiveBox(nodes[index]);
+		}
+		if (level == depth)
+		{
+			return;
+		}
+
+		uint32_t first = static_cast<uint32_t>(nodes.size());
+		nodes[index].firstChild = first;
+		nodes.resize(nodes.size() + arity);
+		for (int child = 0; child < arity; child++)
+		{
+			nodes[first + child].parent = index;
+			self(self, first + child, level + 1);
+		}
+
+		// children boxes first, plus the branch itself for the tree
+		glm::vec2 lo = nodes[first].lo, hi = nodes[first].hi;
+		for (int child = 1; child < arity; child++)
+		{
+			lo = glm::min(lo, nodes[first + child].lo);
+			hi = glm::max(hi, nodes[first + child].hi);
+		}
+		if (nodes[index].primitive >= 0)
+		{
+			lo = glm::min(lo, nodes[index].lo);
+			hi = glm::max(hi, nodes[index].hi);
+		}
+		nodes[index].lo = lo;
+		nodes[index].hi = hi;
+	};
+
+	nodes.reserve(2 * primitives);
+	nodes.resize(1);
+	nodes[0].parent = 0;
+	fill(fill, 0, 0);
+}
+
+
+void PickIndex::remap(const std::vector<uint32_t> &order)
+{
+	for (size_t i = 0; i < order.size() && i < bufferIndex.size(); i++)
+	{
+		bufferIndex[order[i]] = static_cast<uint32_t>(i);
+	}
+}
+
+
+float PickIndex::distanceTo(const CPU_Geometry &geom, int32_t primitive, glm::vec2 point) const
+{
+	const glm::vec3 *v = &geom.verts[bufferIndex[primitive] * vertsPerPrimitive];
+	if (vertsPerPrimitive == 3)
+	{ // inside when the point is on the same side of all three edges
+		auto side = [&](glm::vec2 a, glm::vec2 b)
+		{ return (b.x - a.x) * (point.y - a.y) - (b.y - a.y) * (point.x - a.x); };
+		float d1 = side(v[0], v[1]), d2 = side(v[1], v[2]), d3 = side(v[2], v[0]);
+		bool hasNegative = d1 < 0.f || d2 < 0.f || d3 < 0.f;
+		bool hasPositive = d1 > 0.f || d2 > 0.f || d3 > 0.f;
+		return (hasNegative && hasPositive) ? std::numeric_limits<float>::max() : 0.f;
+	}
+
+	// distance to the segment
+	glm::vec2 a(v[0]), b(v[1]);
+	glm::vec2 ab = b - a;
+	float lengthSquared = glm::dot(ab, ab);
+	float t = lengthSquared > 0.f ? std::clamp(glm::dot(point - a, ab) / lengthSquared, 0.f, 1.f) : 0.f;
+	return glm::length(point - (a + t * ab));
+}
+
+
+PickResult PickIndex::pick(const CPU_Geometry &geom, glm::vec2 point, float tolerance) const
+{
+	PickResult result;
+	if (nodes.empty())
+	{
+		return result;
+	}
+
+	float best = (vertsPerPrimitive == 3) ? 0.f : tolerance; // triangles have to contain the point
+	uint32_t bestNode = 0;
+
+	// depth first, skipping every box further away than the best hit so far. The stack never holds
+	// more than (arity - 1) nodes per level, and primitives are well below 2^32 levels deep
+	uint32_t stack[256];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		const Node &node = nodes[stack[--top]];
+		glm::vec2 outside = glm::max(glm::max(node.lo - point, point - node.hi), glm::vec2(0.f));
+		if (glm::length(outside) > best)
+		{
+			continue;
+		}
+
+		if (node.primitive >= 0)
+		{
+			float distance = distanceTo(geom, node.primitive, point);
+			if (distance <= best && (result.primitive < 0 || distance < result.distance || vertsPerPrimitive == 3))
+			{ // later triangles are drawn on top, so the last hit wins
+				result.primitive = node.primitive;
+				result.distance = distance;
+				bestNode = static_cast<uint32_t>(&node - nodes.data());
+				best = (vertsPerPrimitive == 3) ? 0.f : distance;
+			}
+		}
+		if (node.firstChild != 0 && top + arity <= 256)
+		{
+			for (int child = arity - 1; child >= 0; child--)
+			{ // pushed backwards so the first child is visited first
+				stack[top++] = node.firstChild + child;
+			}
+		}
+	}
+
+	if (result.primitive >= 0)
+	{
+		// walk back up to the root to get the path the recursion took
+		for (uint32_t index = bestNode; index != 0; index = nodes[index].parent)
+		{
+			result.path.push_back(static_cast<int>(index - nodes[nodes[index].parent].firstChild));
+		}
+		std::reverse(result.path.begin(), result.path.end());
+		result.primitive = static_cast<int>(bufferIndex[result.primitive]);
+	}
+	return result;
+}
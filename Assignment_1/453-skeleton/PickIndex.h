@@ -0,0 +1,59 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// A bounding volume hierarchy over a generated fractal, used to find the
+// primitive under the mouse. The recursion that generated the fractal already
+// is a perfect hierarchy (every call has 2 or 3 sub-calls), so the BVH simply
+// mirrors it: one node per generate call, boxed around everything it emitted.
+// A pick walks down from the root, touching a few nodes per level.
+//------------------------------------------------------------------------------
+
+#include "Geometry.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+
+struct PickResult
+{
+	int primitive = -1;	   // index of the primitive in the geometry (after any reordering), -1 for a miss
+	std::vector<int> path; // the child taken at every level of the recursion, root first
+	float distance = 0.f;  // from the point to the primitive, 0 when inside a triangle
+};
+
+
+class PickIndex
+{
+public:
+	// Mirrors a recursion with `arity` calls per level, `depth` levels deep. The geometry must still be in
+	// recursion order. Sierpinski and Levy only emit at the leaves, the tree emits at every call
+	// (innerPrimitives), before its children
+	void build(const CPU_Geometry &geom, int vertsPerPrimitive, int arity, int depth, bool innerPrimitives);
+	void clear() { nodes.clear(); }
+
+	// After reorderPrimitives(), so picks report where the primitive is now (order[new] = old)
+	void remap(const std::vector<uint32_t> &order);
+
+	// The primitive under point. Triangles must contain it, segments must be within tolerance
+	// (the closest one wins). Every coordinate is in the same space as the geometry
+	PickResult pick(const CPU_Geometry &geom, glm::vec2 point, float tolerance) const;
+
+private:
+	struct Node
+	{
+		glm::vec2 lo;
+		glm::vec2 hi;
+		int32_t primitive;	 // recursion-order index of the primitive this call emitted, -1 for none
+		uint32_t firstChild; // children are stored next to each other, 0 for a leaf
+		uint32_t parent;
+	};
+
+	std::vector<Node> nodes; // nodes[0] is the root
+	std::vector<uint32_t> bufferIndex; // recursion order -> position of the primitive in the geometry
+	int arity = 0;
+	int vertsPerPrimitive = 0;
+
+	float distanceTo(const CPU_Geometry &geom, int32_t primitive, glm::vec2 point) const;
+};
@@ -0,0 +1,249 @@
+#include "PrimitiveOrder.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <type_traits>
+
+
+// Sorts by the upper 32 bits (the key), the lower 32 bits carry the primitive index along.
+// LSD radix sort, 8 bits per pass. Every pass is stable, so equal keys stay in recursion order
+static void radixSortKeys(std::vector<uint64_t> &items, int threads)
+{
+	std::vector<uint64_t> scratch(items.size());
+	std::vector<std::array<size_t, 256>> counts(std::max(threads, 1));
+
+	for (int shift = 32; shift < 64; shift += 8)
+	{
+		// every thread counts the digits in its own chunk
+		for (auto &count : counts)
+		{
+			count.fill(0);
+		}
+		parallelFor(items.size(), threads, [&](size_t begin, size_t end, int t)
+					{
+			for (size_t i = begin; i < end; i++)
+			{
+				counts[t][(items[i] >> shift) & 0xFF]++;
+			} });
+
+		// digit-major, thread-minor prefix sum gives every thread its own place in every bucket
+		size_t offset = 0;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			for (auto &count : counts)
+			{
+				size_t n = count[digit];
+				count[digit] = offset;
+				offset += n;
+			}
+		}
+
+		parallelFor(items.size(), threads, [&](size_t begin, size_t end, int t)
+					{
+			for (size_t i = begin; i < end; i++)
+			{
+				scratch[counts[t][(items[i] >> shift) & 0xFF]++] = items[i];
+			} });
+		items.swap(scratch);
+	}
+}
+
+
+uint32_t mortonKey(uint32_t x, uint32_t y)
+{
+	// spread the 16 bits of each out to every other bit, then interleave them
+	auto spread = [](uint32_t v)
+	{
+		v &= 0xFFFF;
+		v = (v | (v << 8)) & 0x00FF00FF;
+		v = (v | (v << 4)) & 0x0F0F0F0F;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	};
+	return spread(x) | (spread(y) << 1);
+}
+
+
+uint32_t hilbertKey(uint32_t x, uint32_t y)
+{
+	// the classic rotate-and-flip walk from the top bit down
+	// https://en.wikipedia.org/wiki/Hilbert_curve#Applications_and_mapping_algorithms
+	uint32_t d = 0;
+	for (uint32_t s = 1u << 15; s > 0; s >>= 1)
+	{
+		uint32_t rx = (x & s) > 0;
+		uint32_t ry = (y & s) > 0;
+		d += s * s * ((3 * rx) ^ ry);
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = s - 1 - x;
+				y = s - 1 - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return d;
+}
+
+
+static uint32_t curveKey(CurveType curve, uint32_t x, uint32_t y)
+{
+	return curve == CurveType::Hilbert ? hilbertKey(x, y) : mortonKey(x, y);
+}
+
+
+CurveOrdering reorderPrimitives(CPU_Geometry &geom, int vertsPerPrimitive, CurveType curve, int threads)
+{
+	CurveOrdering ordering;
+	ordering.curve = curve;
+	ordering.vertsPerPrimitive = vertsPerPrimitive;
+	threads = threadCount(threads);
+
+	const size_t primitives = geom.verts.size() / vertsPerPrimitive;
+	if (curve == CurveType::Recursion || primitives == 0)
+	{
+		return ordering;
+	}
+
+	// centre and half size of every primitive, and a square around all of them
+	std::vector<glm::vec2> centres(primitives);
+	glm::vec2 lo(geom.verts.front()), hi(geom.verts.front());
+	for (size_t p = 0; p < primitives; p++)
+	{
+		glm::vec2 pMin(geom.verts[p * vertsPerPrimitive]), pMax = pMin;
+		for (int v = 1; v < vertsPerPrimitive; v++)
+		{
+			pMin = glm::min(pMin, glm::vec2(geom.verts[p * vertsPerPrimitive + v]));
+			pMax = glm::max(pMax, glm::vec2(geom.verts[p * vertsPerPrimitive + v]));
+		}
+		centres[p] = 0.5f * (pMin + pMax);
+		ordering.maxHalfExtent = glm::max(ordering.maxHalfExtent, 0.5f * (pMax - pMin));
+		lo = glm::min(lo, pMin);
+		hi = glm::max(hi, pMax);
+	}
+	ordering.boundsMin = lo;
+	ordering.boundsSize = std::max(std::max(hi.x - lo.x, hi.y - lo.y), 1e-6f);
+
+	// key in the top half, primitive index in the bottom half
+	std::vector<uint64_t> items(primitives);
+	// the same scale cullRanges maps cells back with, the far edge (exactly boundsSize) goes in the last cell
+	const float toGrid = 65536.f / ordering.boundsSize;
+	parallelFor(primitives, threads, [&](size_t begin, size_t end, int)
+				{
+		for (size_t p = begin; p < end; p++)
+		{
+			glm::vec2 cell = glm::min((centres[p] - ordering.boundsMin) * toGrid, glm::vec2(65535.f));
+			uint32_t key = curveKey(curve, static_cast<uint32_t>(cell.x), static_cast<uint32_t>(cell.y));
+			items[p] = (static_cast<uint64_t>(key) << 32) | p;
+		} });
+
+	radixSortKeys(items, threads);
+
+	ordering.keys.resize(primitives);
+	ordering.order.resize(primitives);
+	for (size_t i = 0; i < primitives; i++)
+	{
+		ordering.keys[i] = static_cast<uint32_t>(items[i] >> 32);
+		ordering.order[i] = static_cast<uint32_t>(items[i]);
+	}
+
+	// move whole primitives, every per-vertex array the same way
+	auto permute = [&](auto &data)
+	{
+		if (data.size() != geom.verts.size())
+		{
+			return; // optional arrays (like the ancestors or the colours) may be empty
+		}
+		std::decay_t<decltype(data)> sorted(data.size(), data.get_allocator()); // same resource, so swap is allowed
+		parallelFor(primitives, threads, [&](size_t begin, size_t end, int)
+					{
+			for (size_t i = begin; i < end; i++)
+			{
+				std::copy_n(data.begin() + ordering.order[i] * vertsPerPrimitive, vertsPerPrimitive, sorted.begin() + i * vertsPerPrimitive);
+			} });
+		data.swap(sorted);
+	};
+	permute(geom.verts);
+	permute(geom.cols);
+	permute(geom.ancestors);
+	permute(geom.shades);
+
+	return ordering;
+}
+
+
+std::vector<std::pair<GLint, GLsizei>> cullRanges(const CurveOrdering &ordering, glm::vec2 lo, glm::vec2 hi, int maxLevel)
+{
+	std::vector<std::pair<uint32_t, uint32_t>> primitiveRanges; // [first, last)
+
+	// grow the rectangle by the biggest primitive, so testing centres never misses an overlap
+	lo -= ordering.maxHalfExtent;
+	hi += ordering.maxHalfExtent;
+	const float cellUnit = ordering.boundsSize / 65536.f;
+
+	std::function<void(int, uint32_t, uint32_t)> visit = [&](int level, uint32_t x, uint32_t y)
+	{
+		// cell (x, y) at this level covers 2^(16 - level) grid units on each side
+		const uint32_t side = 1u << (16 - level);
+		glm::vec2 cellLo = ordering.boundsMin + glm::vec2(x * side, y * side) * cellUnit;
+		glm::vec2 cellHi = cellLo + glm::vec2(side * cellUnit);
+		if (cellHi.x < lo.x || cellLo.x > hi.x || cellHi.y < lo.y || cellLo.y > hi.y)
+		{
+			return;
+		}
+
+		bool inside = cellLo.x >= lo.x && cellHi.x <= hi.x && cellLo.y >= lo.y && cellHi.y <= hi.y;
+		if (inside || level == maxLevel)
+		{
+			// every point of an aligned cell shares the top 2 * level bits of its key, on both curves
+			const uint64_t span = uint64_t(1) << (2 * (16 - level));
+			uint64_t first = curveKey(ordering.curve, x * side, y * side) & ~(span - 1);
+			auto begin = std::lower_bound(ordering.keys.begin(), ordering.keys.end(), first);
+			auto end = std::lower_bound(begin, ordering.keys.end(), first + span,
+										[](uint32_t key, uint64_t value)
+										{ return key < value; });
+			if (begin != end)
+			{
+				primitiveRanges.emplace_back(static_cast<uint32_t>(begin - ordering.keys.begin()), static_cast<uint32_t>(end - ordering.keys.begin()));
+			}
+			return;
+		}
+
+		for (uint32_t child = 0; child < 4; child++)
+		{
+			visit(level + 1, 2 * x + (child & 1), 2 * y + (child >> 1));
+		}
+	};
+	if (!ordering.keys.empty())
+	{
+		visit(0, 0, 0);
+	}
+
+	// neighbouring cells are often neighbours on the curve too, merge them into single draws
+	std::sort(primitiveRanges.begin(), primitiveRanges.end());
+	std::vector<std::pair<uint32_t, uint32_t>> merged;
+	for (const auto &range : primitiveRanges)
+	{
+		if (!merged.empty() && range.first <= merged.back().second)
+		{
+			merged.back().second = std::max(merged.back().second, range.second);
+		}
+		else
+		{
+			merged.push_back(range);
+		}
+	}
+
+	std::vector<std::pair<GLint, GLsizei>> ranges;
+	for (const auto &range : merged)
+	{
+		ranges.emplace_back(static_cast<GLint>(range.first * ordering.vertsPerPrimitive), static_cast<GLsizei>((range.second - range.first) * ordering.vertsPerPrimitive));
+	}
+	return ranges;
+}
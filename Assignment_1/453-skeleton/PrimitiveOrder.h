@@ -0,0 +1,53 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// Reorders the primitives of a CPU_Geometry along a space-filling curve, so that
+// primitives close together on screen are also close together in the vertex
+// buffer, and any square (quadtree) cell of the screen becomes one contiguous
+// run of primitives. Generators emit in recursion order, which is only coherent
+// inside each subtree.
+//------------------------------------------------------------------------------
+
+#include "Geometry.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+enum class CurveType
+{
+	Recursion, // leave the generator's order alone
+	Morton,
+	Hilbert
+};
+
+
+// What reorderPrimitives did, kept around for culling (and for mapping back to recursion order)
+struct CurveOrdering
+{
+	CurveType curve = CurveType::Recursion;
+	int vertsPerPrimitive = 1;
+	std::vector<uint32_t> keys;	 // curve key of every primitive, in the new (sorted) order
+	std::vector<uint32_t> order; // order[i] is the recursion-order index of the primitive now at i
+	glm::vec2 boundsMin = glm::vec2(0.f); // the square the keys were quantized over
+	float boundsSize = 0.f;
+	glm::vec2 maxHalfExtent = glm::vec2(0.f); // biggest primitive, keeps the culling conservative
+};
+
+
+// Keys for a point on a 65536 x 65536 grid
+uint32_t mortonKey(uint32_t x, uint32_t y);
+uint32_t hilbertKey(uint32_t x, uint32_t y);
+
+// Sorts the primitives (verts, cols and ancestors together) by the curve key of their centre.
+// The keys are sorted with a parallel LSD radix sort, threads = 0 uses every hardware thread
+CurveOrdering reorderPrimitives(CPU_Geometry &geom, int vertsPerPrimitive, CurveType curve, int threads = 0);
+
+// (first vertex, vertex count) ranges holding every primitive that may touch the rectangle.
+// The quadtree is walked down to maxLevel and every cell overlapping the rectangle becomes
+// one binary-searched range of keys. Only valid for Morton or Hilbert orderings
+std::vector<std::pair<GLint, GLsizei>> cullRanges(const CurveOrdering &ordering, glm::vec2 lo, glm::vec2 hi, int maxLevel = 6);
@@ -0,0 +1,119 @@
+#include "SegmentDedup.h"
+
+#include "Parallel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// Both endpoints in lattice units, the smaller point first so a segment and its reverse match,
+// 16 bits per coordinate (plenty, the curve stays within a few units of the origin).
+// 0 would be a segment from a point to itself, so it marks an empty slot
+static uint64_t segmentKey(glm::vec3 a, glm::vec3 b, float scale)
+{
+	auto snap = [scale](float coordinate)
+	{
+		return static_cast<uint64_t>(static_cast<uint16_t>(std::lround(coordinate * scale) + 0x8000));
+	};
+	uint64_t pa = (snap(a.x) << 16) | snap(a.y);
+	uint64_t pb = (snap(b.x) << 16) | snap(b.y);
+	if (pb < pa)
+	{
+		std::swap(pa, pb);
+	}
+	return (pa << 32) | pb;
+}
+
+// fmix64 from MurmurHash3, the keys are very regular so they need mixing
+static uint64_t mix(uint64_t key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ull;
+	key ^= key >> 33;
+	return key;
+}
+
+
+SegmentDedupStats removeDuplicateSegments(CPU_Geometry &geom, float latticeStep, int threads)
+{
+	auto start = std::chrono::steady_clock::now();
+	threads = threadCount(threads);
+	const float scale = 1.0f / latticeStep;
+	const size_t segments = geom.verts.size() / 2;
+
+	SegmentDedupStats stats;
+	stats.emitted = segments;
+
+	// open addressing, at most half full. Every slot remembers the last segment with its key
+	size_t capacity = 16;
+	while (capacity < 2 * segments)
+	{
+		capacity *= 2;
+	}
+	const size_t mask = capacity - 1;
+	std::vector<std::atomic<uint64_t>> keys(capacity); // value initialised, so all empty
+	std::vector<std::atomic<uint32_t>> lastSegment(capacity);
+	std::vector<uint32_t> slotOf(segments);
+
+	parallelFor(segments, threads, [&](size_t begin, size_t end, int)
+				{
+		for (size_t s = begin; s < end; s++)
+		{
+			const uint64_t key = segmentKey(geom.verts[2 * s], geom.verts[2 * s + 1], scale);
+			size_t slot = mix(key) & mask;
+			while (true)
+			{
+				uint64_t found = keys[slot].load(std::memory_order_relaxed);
+				if (found == 0 && keys[slot].compare_exchange_strong(found, key, std::memory_order_relaxed))
+				{
+					found = key; // claimed it
+				}
+				if (found == key)
+				{
+					break;
+				}
+				slot = (slot + 1) & mask; // someone else's key
+			}
+			slotOf[s] = static_cast<uint32_t>(slot);
+
+			// atomic max, the threads get their chunks in any order
+			uint32_t last = lastSegment[slot].load(std::memory_order_relaxed);
+			while (s > last && !lastSegment[slot].compare_exchange_weak(last, static_cast<uint32_t>(s), std::memory_order_relaxed))
+			{
+			}
+		} });
+
+	// compact in place, a kept segment only ever moves towards the front
+	auto compact = [&](auto &data)
+	{
+		if (data.size() != geom.verts.size())
+		{
+			return size_t(0); // optional arrays may be empty
+		}
+		size_t kept = 0;
+		for (size_t s = 0; s < segments; s++)
+		{
+			if (lastSegment[slotOf[s]].load(std::memory_order_relaxed) == s)
+			{
+				data[2 * kept] = data[2 * s];
+				data[2 * kept + 1] = data[2 * s + 1];
+				kept++;
+			}
+		}
+		data.resize(2 * kept);
+		return kept;
+	};
+	compact(geom.cols);
+	compact(geom.ancestors);
+	compact(geom.shades);
+	stats.unique = compact(geom.verts); // last, the others compare their size against it
+
+	stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return stats;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// Removes line segments that retrace another one. The Levy C curve overlaps
+// itself more and more with depth (about one segment in eight at depth 12), and
+// every retraced segment is vertices, overdraw and export size for nothing.
+//
+// The endpoints are snapped onto the lattice the curve lives on, so equal points
+// compare equal whatever float error the recursion picked up. A segment and its
+// reverse are the same segment. Of every set of duplicates the LAST one is kept,
+// since with GL_LINES drawn in order that is the one on screen, so the render
+// doesn't change.
+//------------------------------------------------------------------------------
+
+#include "Geometry.h"
+
+#include <cstddef>
+
+
+struct SegmentDedupStats
+{
+	size_t emitted = 0;
+	size_t unique = 0;
+	double ms = 0.0;
+};
+
+// geom holds GL_LINES pairs, every endpoint a multiple of latticeStep (see levyLatticeStep).
+// Compacts every per-vertex array of geom, keeping the order of what stays.
+// The duplicates are found with a hash set shared by all threads, threads = 0 uses every hardware thread
+SegmentDedupStats removeDuplicateSegments(CPU_Geometry &geom, float latticeStep, int threads = 0);
@@ -0,0 +1,19 @@
+#include "SegmentDedupBenchmark.h"
+
+#include "Fractals.h"
+#include "Geometry.h"
+#include "Log.h"
+#include "SegmentDedup.h"
+
+
+void reportSegmentOverlap(int maxDepth)
+{
+	CPU_Geometry geom;
+	for (int depth = 0; depth <= maxDepth; depth++)
+	{
+		generateLevyCurve(geom, depth);
+		SegmentDedupStats stats = removeDuplicateSegments(geom, levyLatticeStep(depth));
+		Log::info("LEVY_OVERLAP depth {}: {} unique of {} segments ({:.1f}% retraced), {:.3f} ms", depth, stats.unique,
+				  stats.emitted, 100.0 * (stats.emitted - stats.unique) / stats.emitted, stats.ms);
+	}
+}
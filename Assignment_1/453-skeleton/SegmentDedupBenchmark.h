@@ -0,0 +1,8 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// How much of the Levy curve removeDuplicateSegments drops, and what finding
+// the duplicates costs, at every depth from 0 to maxDepth. Logs one line per depth.
+//------------------------------------------------------------------------------
+
+void reportSegmentOverlap(int maxDepth);
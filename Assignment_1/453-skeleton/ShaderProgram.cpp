@@ -7,12 +7,35 @@
 #include <vector>
 
 ShaderProgram::ShaderProgram(const std::string& vertexPath, const std::string& fragmentPath)
+	: ShaderProgram(vertexPath, "", fragmentPath)
+{}
+
+
+ShaderProgram::ShaderProgram(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath,
+	const std::vector<std::string>& feedbackVaryings)
 	: programID()
 	, vertex(vertexPath, GL_VERTEX_SHADER)
 	, fragment(fragmentPath, GL_FRAGMENT_SHADER)
+	, feedbackVaryings(feedbackVaryings)
 {
+	if (!geometryPath.empty()) {
+		geometry.emplace(geometryPath, GL_GEOMETRY_SHADER);
+	}
+
 	attach(*this, vertex);
+	if (geometry) {
+		attach(*this, *geometry);
+	}
 	attach(*this, fragment);
+
+	// which outputs transform feedback captures is part of the link
+	if (!feedbackVaryings.empty()) {
+		std::vector<const GLchar*> names;
+		for (const std::string& name : feedbackVaryings) {
+			names.push_back(name.c_str());
+		}
+		glTransformFeedbackVaryings(programID, static_cast<GLsizei>(names.size()), names.data(), GL_SEPARATE_ATTRIBS);
+	}
 	glLinkProgram(programID);
 
 	if (!checkAndLogLinkSuccess()) {
@@ -25,7 +48,7 @@ bool ShaderProgram::recompile() {
 
 	try {
 		// Try to create a new program
-		ShaderProgram newProgram(vertex.getPath(), fragment.getPath());
+		ShaderProgram newProgram(vertex.getPath(), geometry ? geometry->getPath() : "", fragment.getPath(), feedbackVaryings);
 		*this = std::move(newProgram);
 		return true;
 	}
@@ -52,16 +75,18 @@ bool ShaderProgram::checkAndLogLinkSuccess() const {
 		std::vector<char> log(logLength);
 		glGetProgramInfoLog(programID, logLength, NULL, log.data());
 
-		Log::error("SHADER_PROGRAM linking {} + {}:\n{}",
+		Log::error("SHADER_PROGRAM linking {} + {}{}:\n{}",
 			  vertex.getPath()
+			, geometry ? geometry->getPath() + " + " : ""
 			, fragment.getPath()
 			, log.data()
 		);
 		return false;
 	}
 	else {
-		Log::info("SHADER_PROGRAM successfully compiled and linked {} + {}",
+		Log::info("SHADER_PROGRAM successfully compiled and linked {} + {}{}",
 			  vertex.getPath()
+			, geometry ? geometry->getPath() + " + " : ""
 			, fragment.getPath()
 		);
 		return true;
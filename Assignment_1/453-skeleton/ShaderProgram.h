@@ -3,17 +3,23 @@
 #include "Shader.h"
 
 #include "GLHandles.h"
+#include "GLState.h"
 
 #include <glad/glad.h>
 
 #include <string>
 #include <optional>
+#include <vector>
 
 
 class ShaderProgram {
 
 public:
 	ShaderProgram(const std::string& vertexPath, const std::string& fragmentPath);
+	// With an optional geometry stage (empty path for none), and outputs to capture with transform
+	// feedback. Every captured varying goes to its own buffer, bound at its index in feedbackVaryings
+	ShaderProgram(const std::string& vertexPath, const std::string& geometryPath, const std::string& fragmentPath,
+		const std::vector<std::string>& feedbackVaryings = {});
 	// Because we're using the ShaderProgramHandle to do RAII for the shader for us
 	// and our other types are trivial or provide their own RAII
 	// we don't have to provide any specialized functions here. Rule of zero
@@ -23,7 +29,7 @@ public:
 
 	// Public interface
 	bool recompile();
-	void use() const { glUseProgram(programID); }
+	void use() const { GLState::useProgram(programID); }
 
 	void friend attach(ShaderProgram& sp, Shader& s);
 
@@ -35,7 +41,9 @@ private:
 	ShaderProgramHandle programID;
 
 	Shader vertex;
+	std::optional<Shader> geometry;
 	Shader fragment;
+	std::vector<std::string> feedbackVaryings;
 
 	bool checkAndLogLinkSuccess() const;
 };
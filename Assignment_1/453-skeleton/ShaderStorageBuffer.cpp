@@ -0,0 +1,26 @@
+#include "ShaderStorageBuffer.h"
+
+#ifdef GL_VERSION_4_3
+
+ShaderStorageBuffer::ShaderStorageBuffer()
+	: bufferID{}
+	, allocated(0)
+{}
+
+
+void ShaderStorageBuffer::reserve(GLsizeiptr size, GLenum usage) {
+	if (size <= allocated) {
+		return;
+	}
+	bind();
+	glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, usage);
+	allocated = size;
+}
+
+
+void ShaderStorageBuffer::uploadData(GLintptr offset, GLsizeiptr size, const void* data) {
+	bind();
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data);
+}
+
+#endif
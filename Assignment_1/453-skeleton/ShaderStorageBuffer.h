@@ -0,0 +1,33 @@
+#pragma once
+
+#include "GLHandles.h"
+#include "GLState.h"
+
+#include <glad/glad.h>
+
+#ifdef GL_VERSION_4_3
+
+// A buffer that shaders read and write directly (std430 layout), e.g. compute shader output
+// that a vertex shader then pulls its vertices from. GL 4.3 and later, see ComputeProgram.h
+class ShaderStorageBuffer {
+
+public:
+	ShaderStorageBuffer();
+	// Rule of zero, like VertexBuffer
+
+	// Public interface
+	void bind() const { GLState::bindBuffer(GL_SHADER_STORAGE_BUFFER, bufferID); }
+	// Makes it the buffer at `layout (binding = index)` in the shaders
+	void bindBase(GLuint index) const { GLState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, index, bufferID); }
+
+	// Reallocates only when growing, the contents are undefined afterwards
+	void reserve(GLsizeiptr size, GLenum usage);
+	void uploadData(GLintptr offset, GLsizeiptr size, const void* data);
+	GLsizeiptr capacity() const { return allocated; }
+
+private:
+	ShaderStorageBufferHandle bufferID;
+	GLsizeiptr allocated;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GLHandles.h"
+#include "GLState.h"
 
 #include <glad/glad.h>
 #include <string>
@@ -27,8 +28,8 @@ public:
 	// the assumption that most students will want to work with ints, not uints, in main.cpp
 	glm::ivec2 getDimensions() const { return glm::uvec2(width, height); }
 
-	void bind() { glBindTexture(GL_TEXTURE_2D, textureID); }
-	void unbind() { glBindTexture(GL_TEXTURE_2D, textureID); }
+	void bind() { GLState::bindTexture(GL_TEXTURE_2D, textureID); }
+	void unbind() { GLState::bindTexture(GL_TEXTURE_2D, 0); }
 
 private:
 	TextureHandle textureID;
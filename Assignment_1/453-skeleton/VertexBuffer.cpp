@@ -3,12 +3,18 @@
 #include <utility>
 
 
-VertexBuffer::VertexBuffer(GLuint index, GLint size, GLenum dataType)
+VertexBuffer::VertexBuffer(GLuint index, GLint size, GLenum dataType, GLuint divisor)
 	: bufferID{}
+	, index(index)
+	, components(size)
+	, dataType(dataType)
+	, mapped(false)
 {
-	bind();
-	glVertexAttribPointer(index, size, dataType, GL_FALSE, 0, (void*)0);
-	glEnableVertexAttribArray(index);
+	setOffset(0);
+	setEnabled(true);
+	if (divisor != 0) {
+		setDivisor(divisor);
+	}
 }
 
 
@@ -16,3 +22,45 @@ void VertexBuffer::uploadData(GLsizeiptr size, const void* data, GLenum usage) {
 	bind();
 	glBufferData(GL_ARRAY_BUFFER, size, data, usage);
 }
+
+
+void* VertexBuffer::map(GLsizeiptr size, GLenum usage) {
+	bind();
+	glBufferData(GL_ARRAY_BUFFER, size, nullptr, usage);
+	if (size == 0) {
+		return nullptr; // mapping nothing is an error
+	}
+	mapped = true;
+	return glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+}
+
+
+bool VertexBuffer::unmap() {
+	if (!mapped) {
+		return true;
+	}
+	mapped = false;
+	bind();
+	return glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+}
+
+
+void VertexBuffer::setDivisor(GLuint divisor) const {
+	glVertexAttribDivisor(index, divisor);
+}
+
+
+void VertexBuffer::setEnabled(bool enabled) const {
+	if (enabled) {
+		glEnableVertexAttribArray(index);
+	}
+	else {
+		glDisableVertexAttribArray(index);
+	}
+}
+
+
+void VertexBuffer::setOffset(GLintptr offset) const {
+	bind();
+	glVertexAttribPointer(index, components, dataType, GL_FALSE, 0, (void*)offset);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GLHandles.h"
+#include "GLState.h"
 
 #include <glad/glad.h>
 
@@ -8,7 +9,8 @@
 class VertexBuffer {
 
 public:
-	VertexBuffer(GLuint index, GLint size, GLenum dataType);
+	// A non-zero divisor makes it a per-instance attribute from the start (see setDivisor)
+	VertexBuffer(GLuint index, GLint size, GLenum dataType, GLuint divisor = 0);
 
 	// Because we're using the VertexBufferHandle to do RAII for the buffer for us
 	// and our other types are trivial or provide their own RAII
@@ -18,10 +20,33 @@ public:
 	// https://github.com/isocpp/CppCoreGuidelines/blob/master/CppCoreGuidelines.md#Rc-zero
 
 	// Public interface
-	void bind() const { glBindBuffer(GL_ARRAY_BUFFER, bufferID); }
+	void bind() const { GLState::bindBuffer(GL_ARRAY_BUFFER, bufferID); }
 	void uploadData(GLsizeiptr size, const void* data, GLenum usage);
 
+	// Allocates size bytes and maps them write-only. The old contents are invalidated, so the
+	// driver never has to wait for draws still using them. Returns null for an empty buffer
+	void* map(GLsizeiptr size, GLenum usage);
+	// Returns false if the contents were lost while mapped (and must be written again)
+	bool unmap();
+
+	// Makes this buffer where transform feedback writes the varying at index `binding`
+	void bindFeedback(GLuint binding) const { GLState::bindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, binding, bufferID); }
+
+	// Per-instance attributes: a divisor of 1 advances the attribute once per
+	// instance instead of once per vertex (needs the owning VAO to be bound)
+	void setDivisor(GLuint divisor) const;
+	// Re-points the attribute at a byte offset into the buffer. GL 3.3 has no
+	// base instance, so this is how a draw starts part way through the data
+	void setOffset(GLintptr offset) const;
+	// A disabled attribute reads the constant set with glVertexAttrib* (0 by default)
+	void setEnabled(bool enabled) const;
+
 private:
 	VertexBufferHandle bufferID;
+
+	GLuint index;
+	GLint components;
+	GLenum dataType;
+	bool mapped;
 };
 
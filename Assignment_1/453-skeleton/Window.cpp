@@ -1,5 +1,6 @@
 #include "Window.h"
 
+#include "GLState.h"
 #include "Log.h"
 
 #include <iostream>
@@ -53,15 +54,29 @@ Window::Window(
 	: window(nullptr), callbacks(callbacks)
 {
 	// specify OpenGL version
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // needed for mac?
 	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
 
-	// create window
+#ifdef GL_VERSION_4_3
+	// built with the 4.6 loader (FRACTAL_GL46), so try for a context the compute backend can use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	window = std::unique_ptr<GLFWwindow, WindowDeleter>(glfwCreateWindow(width, height, title, monitor, share));
 	if (window == nullptr)
+	{
+		Log::info("WINDOW no OpenGL 4.3 context, falling back to 3.3 (no compute backend)");
+	}
+#endif
+
+	// create window
+	if (window == nullptr)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		window = std::unique_ptr<GLFWwindow, WindowDeleter>(glfwCreateWindow(width, height, title, monitor, share));
+	}
+	if (window == nullptr)
 	{
 		Log::error("WINDOW failed to create GLFW window");
 		throw std::runtime_error("Failed to create GLFW window.");
@@ -73,6 +88,7 @@ Window::Window(
 	{
 		throw std::runtime_error("Failed to initialize GLAD");
 	}
+	GLState::invalidate(); // a new context, nothing it has set is known yet
 
 	glfwSetWindowSizeCallback(window.get(), defaultWindowSizeCallback);
 
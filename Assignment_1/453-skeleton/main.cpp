@@ -6,153 +6,47 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
 
+#include "Forest.h"
+#include "Fractals.h"
+#include "FrameStats.h"
 #include "Geometry.h"
+#include "GeometryArena.h"
+#include "GeometryArenaBenchmark.h"
 #include "GLDebug.h"
+#include "GLState.h"
+#include "GpuSubdivision.h"
+#include "GpuTimer.h"
+#include "ImageCache.h"
+#include "ImageSierpinski.h"
+#include "ImageSierpinskiBenchmark.h"
+#include "InstancedSierpinski.h"
 #include "Log.h"
+#include "MemoryStats.h"
+#include "Palettes.h"
+#include "PerPixelSierpinski.h"
+#include "PickIndex.h"
+#include "PrimitiveOrder.h"
+#include "SegmentDedup.h"
+#include "SegmentDedupBenchmark.h"
 #include "ShaderProgram.h"
 #include "Shader.h"
 #include "Window.h"
 #include "AssetPath.h"
-#include <functional>			   // added this for std::function
+#include "ComputeFractals.h"
 #include <glm/gtx/string_cast.hpp> // this is for printing glm::vec3 types, which I needed during the debugging
 
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
 
-// --- Three Fractal Generating Functions ---
-void generateSierpinskiTriangle(CPU_Geometry &cpuGeom, int depth)
-{
-	// remove all existing vertices and colours from the CPU geometry (the VAO)
-	cpuGeom.verts.clear();
-	cpuGeom.cols.clear();
-
-	// recursively generate a Sierpinski using a lambda function
-	// I prefer lambda function because it has access to the outer scope, and it is a cleaner way to write recursive functions
-	std::function<void(glm::vec3, glm::vec3, glm::vec3, int)> generate =
-		[&](glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, int depth)
-	{
-		if (depth == 0) // Base case: Depth is zero, draw a triangle
-		{
-			cpuGeom.verts.push_back(p1);
-			cpuGeom.verts.push_back(p2);
-			cpuGeom.verts.push_back(p3); // push all three vertices
-
-			// Deterministic color based on vertex positions
-			glm::vec3 color = glm::vec3((p1.x + 1.0f) / 2.0f, (p1.y + 1.0f) / 2.0f, 0.5f); // Color based on point position
-			// all three vertices of a particular triangle will have the same color
-
-			cpuGeom.cols.push_back(color);
-			cpuGeom.cols.push_back(color);
-			cpuGeom.cols.push_back(color);
-		}
-		// recursive case: divide into three smaller triangles
-		else
-		{
-			// these are the midpoints of each side
-			glm::vec3 mid1 = (p1 + p2) / 2.0f;
-			glm::vec3 mid2 = (p2 + p3) / 2.0f;
-			glm::vec3 mid3 = (p1 + p3) / 2.0f;
-
-			// recursively call the generate function on the three smaller triangles
-			generate(p1, mid1, mid3, depth - 1);
-			generate(mid1, p2, mid2, depth - 1);
-			generate(mid3, mid2, p3, depth - 1);
-		}
-	};
-
-	// this is the initial call to the generate function with the main triangle
-	generate(glm::vec3(-0.5f, -0.5f, 0.f), glm::vec3(0.5f, -0.5f, 0.f), glm::vec3(0.f, 0.5f, 0.f), depth);
-}
-
-void generateLevyCurve(CPU_Geometry &cpuGeom, int depth)
-{ // for the c levy curve fractal
-	cpuGeom.verts.clear();
-	cpuGeom.cols.clear();
-
-	std::function<void(glm::vec3, glm::vec3, int, float, float)> generate =
-		[&](glm::vec3 p1, glm::vec3 p2, int depth, float t1, float t2)
-	{
-		if (depth == 0)
-		{
-			// the vector holds all points making the curve, so we push the two points
-			// in the base case, there are only two
-			cpuGeom.verts.push_back(p1);
-			cpuGeom.verts.push_back(p2);
-
-			// Gradient color calculation proceeds based on t1 and t2, which are the t values (a t value is a value between 0 and 1 used for interpolation)
-			glm::vec3 color1 = glm::mix(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), t1); // Red to Green
-			glm::vec3 color2 = glm::mix(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), t2);
-
-			cpuGeom.cols.push_back(color1);
-			cpuGeom.cols.push_back(color2); // added the two colours of line segment
-		}
-		else
-		{
-			glm::vec3 mid = (p1 + p2) / 2.0f; // take the mid point where the next line will be drawn
-			glm::vec3 dir = p2 - p1;		  // find a directional vector
-			glm::vec3 perp = glm::vec3(-dir.y, dir.x, 0.0f);
-			// this is the perpendicular vector to the direction vector, which is used to find the next point
-			// we do this by switching the x and y values and negating one of them
-			mid += glm::normalize(perp) * glm::length(dir) * 0.5f;
-			// as defined, we translate the mid point by half the length of the directional vector in the perpendicular direction
-			float midT = (t1 + t2) / 2.0f;
-			// the t value of the mid point is the average of the two t values of the end points, again this is just an interpolation parameter
-
-			generate(p1, mid, depth - 1, t1, midT); // recursively generate two more curves from the mid point
-			generate(mid, p2, depth - 1, midT, t2);
-		}
-	};
-
-	// we use full interpolation for the first call, so the t values are 0 and 1
-	// interpolation allows us to make the gradient of the line segment
-	generate(glm::vec3(-0.5f, 0.0f, 0.f), glm::vec3(0.5f, 0.0f, 0.f), depth, 0.0f, 1.0f);
-}
-
-void generateTree(CPU_Geometry &cpuGeom, int depth)
-{
-	cpuGeom.verts.clear();
-	cpuGeom.cols.clear();
-
-	std::function<void(glm::vec3, glm::vec3, int)> generate =
-		[&](glm::vec3 start, glm::vec3 end, int currentDepth)
-	{
-		// use a ternary operator to determine the color based on the depth, as described in the assignment
-		glm::vec3 color = (currentDepth <= 3) ? glm::vec3(0.4f, 0.3f, 0.2f) : glm::vec3(0.13f, 0.55f, 0.13f);
-		// according to Google, the colours are "darker desaturated brown" and "forest green"
-
-		cpuGeom.verts.push_back(start); // add two endpoints and draw a line in between them
-		cpuGeom.verts.push_back(end);
-		cpuGeom.cols.push_back(color); // these line segments share the same colour
-		cpuGeom.cols.push_back(color);
-
-		if (currentDepth < depth) // recursive case
-		{
-			glm::vec3 dir = end - start;			 // finding a directional vector
-			float length = glm::length(dir);		 // finding the length of the directional vector aka "length of the branch"
-			glm::vec3 unitDir = glm::normalize(dir); // normalizing the directional vector so that we can scale it
-
-			const float angle = glm::radians(25.7f); // branch angle as defined in the assignment
-			const float cosA = cos(angle);			 // precalculate the cos and sin of the angle
-			const float sinA = sin(angle);
-
-			glm::vec3 branch1End = end + unitDir * (length * 0.5f); // the first branch is just a scaled version of the original branch (straight ahead)
-			glm::vec3 midpoint = (start + end) * 0.5f;				// the midpoint of the branch
-
-			// we need to rotate to get the other two branches
-			glm::vec3 branch2Dir = glm::vec3(unitDir.x * cosA - unitDir.y * sinA, unitDir.x * sinA + unitDir.y * cosA, 0.0f) * (length * 0.5f);	 // this is like + 25.7 degrees from vertical, find its endpoint
-			glm::vec3 branch3Dir = glm::vec3(unitDir.x * cosA + unitDir.y * sinA, -unitDir.x * sinA + unitDir.y * cosA, 0.0f) * (length * 0.5f); // this is like - 25.7 degrees from vertical, find its endpoint
-
-			generate(end, branch1End, currentDepth + 1);				 // first branch
-			generate(midpoint, midpoint + branch2Dir, currentDepth + 1); // second branch
-			generate(midpoint, midpoint + branch3Dir, currentDepth + 1); // third branch, the endpoint is the midpoint plus the rotated vector
-		}
-	};
-	generate(glm::vec3(0.0f, -0.8f, 0.0f), glm::vec3(0.0f, -0.3f, 0.0f), 0);
-}
-
 // --- Different Fractals ---
 
 // Fractal enum
@@ -160,14 +54,16 @@ enum FractalTypes
 {
 	SierpinskiTriangle,
 	LevyCurve,
-	Tree
+	Tree,
+	TreeForest
 }; // this is to reduce the confusion with the switch function
 
 // Create an array of fractal names which match the enum values for printing std::cout
 const char *fractalNames[] = {
 	"Sierpinski Triangle",
 	"Levy Curve",
-	"Tree"};
+	"Tree",
+	"Forest"};
 
 // Fractal configuration
 // use a struct to have the parameters for each fractal (max iteration, current iteration, and drawing mode)
@@ -186,30 +82,568 @@ FractalTypes currentFractal = SierpinskiTriangle;
 FractalConfig fractalConfigs[] = {
 	{6, 0, GL_TRIANGLES}, // Sierpinski Triangle
 	{12, 0, GL_LINES},	  // Levy Curve
-	{10, 0, GL_LINES}	  // Tree
+	{10, 0, GL_LINES},	  // Tree
+	{10, 10, GL_LINES}	  // Forest, the iteration is the deepest LOD any tree may use
 };
 
-void updateFractal(CPU_Geometry &cGeom, GPU_Geometry &gGeom)
+// the tree's angle/scale/branch point, driven by the sliders (and the animation) in the ImGui panel
+TreeParams treeParams;
+
+// how long the last call to a generate function took, shown in the ImGui panel
+double lastGenerateMs = 0.0;
+
+// Where the drawn vertices come from:
+//  - generated into cGeom, then copied into the buffers with glBufferData
+//  - generated straight into mapped GPU buffers, skipping cGeom (and the copy out of it)
+//  - not generated at all, procedural.vert rebuilds every vertex from gl_VertexID with an empty VAO
+//  - Sierpinski only: one base triangle instanced once per leaf (see InstancedSierpinski.h)
+//  - Sierpinski and Levy: the CPU generates gpuLevels fewer levels, a geometry shader adds them (see GpuSubdivision.h)
+//  - GL 4.3+ only: a compute shader generates the fractal into a storage buffer (see ComputeFractals.h)
+//  - Sierpinski only: no geometry, the image is copied into itself at half scale once per level (see ImageSierpinski.h)
+//  - Sierpinski only: no geometry, sierpinski_pixel.frag tests every pixel for membership on its own
+// Only the first keeps the vertices on the CPU, so reordering and picking are off in the others
+enum GeometrySource
+{
+	UploadFromCpu,
+	MapIntoGpu,
+	VertexShader,
+	Instanced,
+	SubdivideOnGpu,
+	ComputeShader,
+	ImageSpace,
+	PerPixel
+};
+const char *geometrySourceNames[] = {
+	"Upload From CPU",
+	"Generate Into GPU Memory",
+	"Vertex Shader",
+	"Instanced (Sierpinski)",
+	"Subdivide On GPU (Sierpinski, Levy)",
+	"Compute Shader (GL 4.3)",
+	"Image Space (Sierpinski)",
+	"Per Pixel (Sierpinski)"};
+GeometrySource geometrySource = UploadFromCpu;
+
+// upload is the setVerts/setCols/setAncestors time, or the map/unmap time when generating into GPU memory
+double lastUploadMs = 0.0;
+size_t lastUploadBytes = 0;
+GLsizei drawCount = 0;	 // vertices to draw, cGeom may be empty
+int proceduralDepth = 0; // the depth procedural.vert rebuilds (one deeper than shown while a morph goes down)
+int instancedDepth = 0;	 // the depth the instanced Sierpinski should be at, it updates itself before drawing
+int gpuLevels = 2;		 // how many of the last levels the GPU subdivides
+int subdivisionLevels = 0;
+bool subdivisionPending = false; // cGeom holds a new coarse fractal for the render loop to subdivide
+bool computeAvailable = false;	 // a 4.3 context and the 4.6 loader, see ComputeFractals.h
+bool computePending = false;	 // the render loop has to dispatch the compute shader again
+const int imageSpaceMaxDepth = 20; // a pass per level costs the same at any depth, so image space goes much deeper
+bool imageBenchmarkPending = false;
+const int perPixelMaxDepth = 30; // the cells are counted in 32 bit, float runs out of bits before that anyway
+glm::vec2 pixelViewCentre(0.0f); // the per pixel view can pan and zoom, nothing else can
+float pixelViewZoomLog2 = 0.0f;
+bool pixelBenchmarkPending = false;
+
+GeometrySource activeSource()
+{ // the other fractals aren't made of identical copies (or aren't pure subdivisions), they are uploaded instead
+	if (geometrySource == Instanced && currentFractal != SierpinskiTriangle)
+	{
+		return UploadFromCpu;
+	}
+	if (geometrySource == SubdivideOnGpu && currentFractal != SierpinskiTriangle && currentFractal != LevyCurve)
+	{
+		return UploadFromCpu;
+	}
+	if (geometrySource == ComputeShader && (!computeAvailable || currentFractal == TreeForest))
+	{ // a 3.3 context falls back to the CPU
+		return UploadFromCpu;
+	}
+	if ((geometrySource == ImageSpace || geometrySource == PerPixel) && currentFractal != SierpinskiTriangle)
+	{ // only the triangle is an exact union of scaled copies of itself (with a closed form membership test)
+		return UploadFromCpu;
+	}
+	return geometrySource;
+}
+
+int depthLimit()
+{ // the deepest the current fractal may go with the current source
+	switch (activeSource())
+	{
+	case ImageSpace:
+		return imageSpaceMaxDepth;
+	case PerPixel:
+		return perPixelMaxDepth;
+	default:
+		return fractalConfigs[currentFractal].maxIteration;
+	}
+}
+
+// Complement emission: the Sierpinski triangle as its root plus the holes, drawn over it in the background
+// colour (see generateSierpinskiHoles). Only for the uploaded/mapped geometry, the other sources bring their own
+bool sierpinskiHoles = false;
+
+bool holesActive()
+{
+	return sierpinskiHoles && currentFractal == SierpinskiTriangle && (activeSource() == UploadFromCpu || activeSource() == MapIntoGpu);
+}
+
+// Overlap removal: the Levy curve retraces itself, the duplicates are dropped after generating (see SegmentDedup.h).
+// It reads the vertices back, so only when they are generated on the CPU
+bool levyDedup = false;
+SegmentDedupStats dedupStats;
+
+bool dedupActive()
+{
+	return levyDedup && currentFractal == LevyCurve && activeSource() == UploadFromCpu;
+}
+
+bool cpuGeometryAvailable()
+{ // the holes aren't leaves, and have to stay behind the root, so they can't be picked or reordered.
+  // Neither can the curve with gaps where its duplicates were
+	return activeSource() == UploadFromCpu && !holesActive() && !dedupActive();
+}
+
+// Shader colours: the uploaded (or mapped) fractals leave their colours to derived_color.vert, which
+// knows the rules, so the colour VBO goes away and a vertex shrinks from 24 bytes to 12-14
+bool shaderColors = false;
+int palette = -1; // a layer of the Palettes texture, or -1 for the fractals' own colours
+
+bool shaderColorsActive()
+{ // the other sources bring their own shaders, the holes have theirs
+	return shaderColors && (activeSource() == UploadFromCpu || activeSource() == MapIntoGpu) && !holesActive();
+}
+
+VertexColors vertexColors()
+{ // what the generator has to write for the colours of the current fractal
+	if (!shaderColorsActive())
+	{
+		return VertexColors::PerVertex;
+	}
+	return currentFractal == SierpinskiTriangle ? VertexColors::Derived : VertexColors::Shades;
+}
+
+size_t colorBytesPerVertex(VertexColors colors)
+{
+	switch (colors)
+	{
+	case VertexColors::PerVertex:
+		return sizeof(glm::vec3);
+	case VertexColors::Shades:
+		return sizeof(std::uint16_t);
+	case VertexColors::Derived:
+		break;
+	}
+	return 0;
+}
+
+// cGeom allocates from this arena, its pages are reused by every regeneration instead of going back to the heap
+GeometryArena geometryArena;
+bool arenaEnabled = true;
+bool arenaHugePages = false;
+
+// Depth morph: a depth change uploads the deeper of the two depths once, with every vertex also
+// carrying where it was one depth up, and basic.vert blends between the two with the "morph" uniform.
+// While the transition plays only that uniform changes, nothing is generated or uploaded. Going down, the
+// deeper depth is still on the GPU when it ends, so the render loop then generates the depth it went to
+struct DepthMorph
+{
+	bool enabled = false;
+	float duration = 0.5f;	 // seconds
+	double startTime = -1.0; // glfwGetTime() when the transition started, negative when there is none
+	bool deepen = true;		 // going up a depth blends ancestors -> vertices, going down the other way
+	FractalTypes shownFractal = SierpinskiTriangle;
+	int shownDepth = 0; // the depth on screen before the last update
+};
+DepthMorph depthMorph;
+
+// Optional reordering of the generated primitives along a space-filling curve (see PrimitiveOrder.h)
+const char *curveNames[] = {
+	"Recursion",
+	"Morton",
+	"Hilbert"};
+CurveType primitiveOrder = CurveType::Recursion;
+CurveOrdering ordering;
+double lastReorderMs = 0.0;
+
+// To show what the curve order buys for culling, the same rectangle (the top right quarter of the
+// window) is culled with a plain scan over every primitive and with the curve's key ranges
+const glm::vec2 cullTestMin(0.0f, 0.0f);
+const glm::vec2 cullTestMax(1.0f, 1.0f);
+struct CullStats
+{
+	double scanUs = 0.0;
+	size_t scanPrimitives = 0;
+	double rangesUs = 0.0;
+	size_t rangePrimitives = 0;
+	std::vector<std::pair<GLint, GLsizei>> ranges;
+};
+CullStats cullStats;
+
+// Picking: a BVH mirroring the recursion is rebuilt with every generate, the cursor callback asks
+// for a pick and the render loop does it (and uploads the highlight) before drawing
+PickIndex pickIndex;
+PickResult picked;
+bool pickingEnabled = true;
+bool pickPending = false;
+glm::vec2 cursorNdc(0.0f);
+double lastPickUs = 0.0;
+
+void measureCulling(const CPU_Geometry &cGeom)
+{
+	const int perPrimitive = ordering.vertsPerPrimitive;
+	auto scanStart = std::chrono::steady_clock::now();
+	cullStats.scanPrimitives = 0;
+	for (size_t first = 0; first + perPrimitive <= cGeom.verts.size(); first += perPrimitive)
+	{ // the bounding box of every primitive against the rectangle
+		glm::vec2 lo(cGeom.verts[first]), hi = lo;
+		for (int v = 1; v < perPrimitive; v++)
+		{
+			lo = glm::min(lo, glm::vec2(cGeom.verts[first + v]));
+			hi = glm::max(hi, glm::vec2(cGeom.verts[first + v]));
+		}
+		if (hi.x >= cullTestMin.x && lo.x <= cullTestMax.x && hi.y >= cullTestMin.y && lo.y <= cullTestMax.y)
+		{
+			cullStats.scanPrimitives++;
+		}
+	}
+	auto rangesStart = std::chrono::steady_clock::now();
+	cullStats.ranges = cullRanges(ordering, cullTestMin, cullTestMax);
+	auto rangesEnd = std::chrono::steady_clock::now();
+
+	cullStats.rangePrimitives = 0;
+	for (const auto &range : cullStats.ranges)
+	{
+		cullStats.rangePrimitives += range.second / perPrimitive;
+	}
+	cullStats.scanUs = std::chrono::duration<double, std::micro>(rangesStart - scanStart).count();
+	cullStats.rangesUs = std::chrono::duration<double, std::micro>(rangesEnd - rangesStart).count();
+}
+
+// CPU time of every frame by phase, with rolling percentiles and a hitch log (see FrameStats.h).
+// Written to frameCsvPath when the app closes if saveFrameCsv is on
+FrameStats frameStats;
+bool saveFrameCsv = false;
+const char *frameCsvPath = "frame_times.csv";
+
+// The GL state changes of the last frame, made and skipped as redundant (see GLState.h)
+GLState::Counters glStateFrame;
+
+// On-demand rendering: instead of redrawing every iteration, the loop sleeps in glfwWaitEvents until
+// something could change the picture (input, a resize, a regeneration, an animation)
+bool redrawOnDemand = false;
+int redrawFrames = 0; // frames still to draw before the loop may sleep again
+
+// Retained image: the fractal pass is drawn into an offscreen target and only blitted onto the window
+// while nothing it is drawn from has changed (see ImageCache.h). sceneVersion counts the geometry
+// changes, the rest of what the pass depends on is compared frame to frame in FractalPassInputs
+bool retainImage = true;
+unsigned sceneVersion = 0;
+
+struct FractalPassInputs
+{
+	unsigned sceneVersion = 0;
+	glm::ivec4 viewport{0};
+	int palette = -1;
+	float morph = 1.0f;
+	bool culledRanges = false;
+	glm::vec2 pixelViewCentre{0.0f}; // the per pixel view
+	float pixelViewZoomLog2 = 0.0f;
+	glm::vec2 forestPosition{0.0f}; // the forest's camera, trees and LOD
+	float forestZoom = 0.0f;
+	int forestTrees = 0;
+	float forestLodPixels = 0.0f;
+
+	bool operator==(const FractalPassInputs &other) const
+	{
+		return std::tie(sceneVersion, viewport, palette, morph, culledRanges, pixelViewCentre, pixelViewZoomLog2, forestPosition,
+						forestZoom, forestTrees, forestLodPixels) ==
+			   std::tie(other.sceneVersion, other.viewport, other.palette, other.morph, other.culledRanges, other.pixelViewCentre,
+						other.pixelViewZoomLog2, other.forestPosition, other.forestZoom, other.forestTrees, other.forestLodPixels);
+	}
+};
+
+// ImGui answers input over the next couple of frames (a hover highlight, a combo closing), so a few frames
+void requestRedraw(int frames = 3)
+{
+	redrawFrames = std::max(redrawFrames, frames);
+}
+
+float morphValue()
+{ // the value for the "morph" uniform this frame
+	if (depthMorph.startTime < 0.0)
+	{
+		return 1.0f;
+	}
+	float t = std::clamp(static_cast<float>((glfwGetTime() - depthMorph.startTime) / depthMorph.duration), 0.0f, 1.0f);
+	return depthMorph.deepen ? t : 1.0f - t;
+}
+
+void generateFractal(CPU_Geometry &cGeom, GPU_Geometry &gGeom)
 {															// now we update the fractal based on the current type/iteration (whatever needs to be updated)
 	FractalConfig &config = fractalConfigs[currentFractal]; // find the entry in the struct array
+	config.currentIteration = std::min(config.currentIteration, depthLimit()); // image space may have gone deeper
+
+	int depth = config.currentIteration;
+	bool withAncestors = false;
+	if (depthMorph.enabled && currentFractal == depthMorph.shownFractal && depth != depthMorph.shownDepth && !holesActive() && !dedupActive())
+	{ // only the last level of a change is animated. Going down, depth+1 is drawn and collapses onto its ancestors
+		depthMorph.deepen = depth > depthMorph.shownDepth;
+		if (!depthMorph.deepen)
+		{
+			depth++;
+		}
+		withAncestors = true;
+		depthMorph.startTime = glfwGetTime();
+	}
+	else
+	{
+		depthMorph.startTime = -1.0;
+	}
+	depthMorph.shownFractal = currentFractal;
+	depthMorph.shownDepth = config.currentIteration;
 
-	// what we do here is call the relevant method this updates the CPU geometry data container before sending it to the GPU
-
+	// every fractal's size is known up front, so the output is allocated exactly once, in the CPU_Geometry
+	// or (generating into GPU memory) in the mapped buffers
+	size_t count = 0;
 	switch (currentFractal)
 	{
 	case SierpinskiTriangle:
-		generateSierpinskiTriangle(cGeom, config.currentIteration);
+		count = holesActive() ? sierpinskiHolesVertexCount(depth) : sierpinskiVertexCount(depth);
 		break;
 	case LevyCurve:
-		generateLevyCurve(cGeom, config.currentIteration);
+		count = levyVertexCount(depth);
 		break;
+	case Tree:
+		count = treeVertexCount(depth);
+		break;
+	case TreeForest: // the forest keeps its own meshes for every depth (see Forest.h), nothing to draw here
+		break;
+	}
+	drawCount = static_cast<GLsizei>(count);
+
+	// the old geometry is dropped entirely, so the arena can rewind and hand the same pages out again
+	cGeom.release();
+	geometryArena.setEnabled(arenaEnabled);
+	geometryArena.setHugePages(arenaHugePages);
+	geometryArena.reset();
+
+	if (activeSource() == Instanced)
+	{ // the instances have no ancestors to morph from, so depth changes jump
+		instancedDepth = config.currentIteration;
+		depthMorph.startTime = -1.0;
+		pickIndex.clear();
+		ordering = CurveOrdering();
+		pickPending = true;
+		return;
+	}
+	if (activeSource() == ImageSpace || activeSource() == PerPixel)
+	{ // nothing to generate, the render loop draws it from scratch every frame
+		depthMorph.startTime = -1.0;
+		drawCount = 0;
+		lastGenerateMs = 0.0;
+		lastUploadMs = 0.0;
+		lastUploadBytes = 0;
+		pickIndex.clear();
+		ordering = CurveOrdering();
+		pickPending = true;
+		return;
+	}
+	if (activeSource() == ComputeShader)
+	{ // generated by the render loop, which owns the GL objects (no ancestors, so no morph)
+		depthMorph.startTime = -1.0;
+		computePending = true;
+		lastUploadMs = 0.0;
+		lastUploadBytes = 0;
+		pickIndex.clear();
+		ordering = CurveOrdering();
+		pickPending = true;
+		return;
+	}
+	if (activeSource() == SubdivideOnGpu)
+	{ // the CPU only goes as deep as depth - gpuLevels, the render loop has the GPU do the rest (no ancestors, so no morph)
+		depthMorph.startTime = -1.0;
+		const int coarseDepth = std::max(0, config.currentIteration - gpuLevels);
+		subdivisionLevels = config.currentIteration - coarseDepth;
+		auto generateStart = std::chrono::steady_clock::now();
+		if (currentFractal == SierpinskiTriangle)
+		{
+			generateSierpinskiTriangle(cGeom, coarseDepth);
+		}
+		else
+		{
+			generateLevyCurve(cGeom, coarseDepth);
+		}
+		lastGenerateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generateStart).count();
+		lastUploadBytes = sizeof(glm::vec3) * cGeom.verts.size() * 2;
+		subdivisionPending = true;
+		pickIndex.clear();
+		ordering = CurveOrdering();
+		pickPending = true;
+		return;
+	}
+	if (activeSource() == VertexShader)
+	{ // nothing to generate or upload, a depth change is just a different uniform and vertex count
+		proceduralDepth = depth;
+		lastGenerateMs = 0.0;
+		lastUploadMs = 0.0;
+		lastUploadBytes = 0;
+		pickIndex.clear();
+		ordering = CurveOrdering();
+		pickPending = true;
+		return;
+	}
 
+	const bool intoGpu = activeSource() == MapIntoGpu && count > 0;
+	const VertexColors colors = vertexColors();
+	lastUploadBytes = count * (sizeof(glm::vec3) * (withAncestors ? 2 : 1) + colorBytesPerVertex(colors));
+	auto uploadStart = std::chrono::steady_clock::now();
+	GeometryOutput out;
+	if (intoGpu)
+	{
+		out = gGeom.map(count, withAncestors, colors);
+	}
+	else
+	{ // only the arrays this fractal needs, the others stay empty (and their attributes off)
+		cGeom.verts.resize(count);
+		cGeom.cols.resize(colors == VertexColors::PerVertex ? count : 0);
+		cGeom.ancestors.resize(withAncestors ? count : 0);
+		cGeom.shades.resize(colors == VertexColors::Shades ? count : 0);
+		out.verts = cGeom.verts.data();
+		out.cols = cGeom.cols.empty() ? nullptr : cGeom.cols.data();
+		out.ancestors = cGeom.ancestors.empty() ? nullptr : cGeom.ancestors.data();
+		out.shades = cGeom.shades.empty() ? nullptr : cGeom.shades.data();
+	}
+	double mapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+
+	// what we do here is call the relevant method, it writes the vertices wherever out points
+	auto generateStart = std::chrono::steady_clock::now();
+	switch (currentFractal)
+	{
+	case SierpinskiTriangle:
+		if (holesActive())
+		{
+			generateSierpinskiHoles(out, depth);
+		}
+		else
+		{
+			generateSierpinskiTriangle(out, depth);
+		}
+		break;
+	case LevyCurve:
+		generateLevyCurve(out, depth);
+		break;
 	case Tree:
-		generateTree(cGeom, config.currentIteration);
+		generateTree(out, depth, treeParams);
 		break;
+	case TreeForest:
+		break;
+	}
+	lastGenerateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generateStart).count();
+
+	if (intoGpu)
+	{
+		auto unmapStart = std::chrono::steady_clock::now();
+		bool intact = gGeom.unmap();
+		lastUploadMs = mapMs + std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - unmapStart).count();
+
+		pickIndex.clear(); // nothing on the CPU to pick from
+		ordering = CurveOrdering();
+		pickPending = true;
+		if (intact)
+		{
+			return;
+		}
+		// very rare (e.g. a display mode change), the driver threw the mapped memory away. Go the CPU way this time
+		Log::warning("GPU buffers were lost while mapped, generating on the CPU instead");
+		geometrySource = UploadFromCpu;
+		generateFractal(cGeom, gGeom);
+		geometrySource = MapIntoGpu;
+		return;
 	}
+
+	pickPending = true; // whatever was under the cursor before is gone
+	if (dedupActive())
+	{
+		dedupStats = removeDuplicateSegments(cGeom, levyLatticeStep(depth));
+		drawCount = static_cast<GLsizei>(cGeom.verts.size());
+		lastUploadBytes = lastUploadBytes / count * cGeom.verts.size();
+	}
+	if (holesActive() || dedupActive())
+	{ // the draw order is the image, no picking or reordering
+		pickIndex.clear();
+		ordering = CurveOrdering();
+	}
+	else
+	{
+		// the pick BVH follows the recursion, so it has to be built while the primitives are still in recursion order
+		const int vertsPerPrimitive = config.drawingMode == GL_TRIANGLES ? 3 : 2;
+		pickIndex.build(cGeom, vertsPerPrimitive, currentFractal == LevyCurve ? 2 : 3, depth, currentFractal == Tree);
+
+		// optional pass, sort the primitives along the chosen curve
+		auto reorderStart = std::chrono::steady_clock::now();
+		ordering = reorderPrimitives(cGeom, vertsPerPrimitive, primitiveOrder);
+		lastReorderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reorderStart).count();
+		if (primitiveOrder != CurveType::Recursion)
+		{
+			pickIndex.remap(ordering.order);
+			measureCulling(cGeom);
+		}
+	}
+
+	uploadStart = std::chrono::steady_clock::now();
 	gGeom.setVerts(cGeom.verts); // Update the geometry from and pass it to the wrapper gGeom to send to GPU
-	gGeom.setCols(cGeom.cols);	 // same thing for colours
+	gGeom.setCols(cGeom.cols);	 // same thing for colours (empty when the shader colours the fractal)
+	gGeom.setShades(cGeom.shades);
+	gGeom.setAncestors(cGeom.ancestors); // empty unless a morph just started
+	lastUploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+}
+
+void updateFractal(CPU_Geometry &cGeom, GPU_Geometry &gGeom)
+{ // called from the panel and the key callback, so the frame stats move the time over to Generate and note it for the hitch log
+	auto start = std::chrono::steady_clock::now();
+	generateFractal(cGeom, gGeom);
+	frameStats.charge(FramePhase::Generate, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	frameStats.note(fmt::format("{} regenerated at depth {}", fractalNames[currentFractal], fractalConfigs[currentFractal].currentIteration));
+	requestRedraw();
+	sceneVersion++;
+}
+
+// --- Tree Benchmark ---
+
+// Frame-time benchmark for the live tree: the angle is animated for a fixed number of frames
+// (so the tree is re-evaluated and re-uploaded every frame) and the frame and generation times
+// are logged at the end. A frame is "dropped" when it takes longer than 60 Hz allows
+struct TreeBenchmark
+{
+	int framesLeft = 0;
+	std::vector<double> frameMs;
+	std::vector<double> generateMs;
+};
+
+void reportTreeBenchmark(TreeBenchmark &benchmark, int depth)
+{
+	auto summary = [](std::vector<double> &times, double &mean, double &p95, double &max)
+	{
+		std::sort(times.begin(), times.end());
+		mean = 0.0;
+		for (double t : times)
+		{
+			mean += t;
+		}
+		mean /= times.size();
+		p95 = times[static_cast<size_t>(0.95 * (times.size() - 1))];
+		max = times.back();
+	};
+
+	const double budgetMs = 1000.0 / 60.0;
+	int dropped = static_cast<int>(std::count_if(benchmark.frameMs.begin(), benchmark.frameMs.end(), [&](double t)
+												 { return t > budgetMs; }));
+
+	double frameMean, frameP95, frameMax, generateMean, generateP95, generateMax;
+	summary(benchmark.frameMs, frameMean, frameP95, frameMax);
+	summary(benchmark.generateMs, generateMean, generateP95, generateMax);
+	Log::info("TREE_BENCHMARK depth {}, {} frames: frame mean {:.3f} ms, p95 {:.3f} ms, max {:.3f} ms, {} over {:.1f} ms",
+			  depth, benchmark.frameMs.size(), frameMean, frameP95, frameMax, dropped, budgetMs);
+	Log::info("TREE_BENCHMARK generation mean {:.3f} ms, p95 {:.3f} ms, max {:.3f} ms",
+			  generateMean, generateP95, generateMax);
 }
 
 // --- Callbacks ---
@@ -218,13 +652,14 @@ class MyCallbacks : public CallbackInterface
 {
 
 public:
-	MyCallbacks(ShaderProgram &shader, CPU_Geometry &cGeom, GPU_Geometry &gGeom) : shader(shader), cGeom(cGeom), gGeom(gGeom) {}
+	MyCallbacks(ShaderProgram &shader, CPU_Geometry &cGeom, GPU_Geometry &gGeom, Window &window) : shader(shader), cGeom(cGeom), gGeom(gGeom), window(window) {}
 
 	virtual void keyCallback(int key, int scancode, int action, int mods) override
 	{							  // respond to key presses
+		requestRedraw();
 		if (action == GLFW_PRESS) // was a key pressed?
 		{
-			if (key >= GLFW_KEY_1 && key <= GLFW_KEY_3) // yes, a key was pressed, but was it a number key?
+			if (key >= GLFW_KEY_1 && key <= GLFW_KEY_4) // yes, a key was pressed, but was it a number key?
 			{
 				currentFractal = static_cast<FractalTypes>(key - GLFW_KEY_1);		   // the enum of fractal types uses zero-based indexing
 				updateFractal(cGeom, gGeom);										   // update the fractal based on the new type and current iteration
@@ -233,7 +668,7 @@ public:
 			else if (key == GLFW_KEY_UP) // increase iteration depth
 			{
 				FractalConfig &config = fractalConfigs[currentFractal];
-				config.currentIteration = std::min(config.currentIteration + 1, config.maxIteration); // increment iteration, at max clamp and do not proceed further
+				config.currentIteration = std::min(config.currentIteration + 1, depthLimit()); // increment iteration, at max clamp and do not proceed further
 				updateFractal(cGeom, gGeom);														  // regenerate fractal
 				std::cout << "Iteration: " << config.currentIteration << std::endl;
 			}
@@ -251,12 +686,36 @@ public:
 		}
 	}
 
-	// not implementing any other callbacks
+	virtual void cursorPosCallback(double xpos, double ypos) override
+	{ // remember where the cursor is in NDC (y flipped, GLFW's origin is the top left), the render loop does the pick
+		glm::ivec2 size = window.getSize();
+		cursorNdc = glm::vec2(2.0 * xpos / size.x - 1.0, 1.0 - 2.0 * ypos / size.y);
+		pickPending = true;
+		requestRedraw(); // the panel's hover highlights, and the pick
+	}
+
+	// the rest only wake the loop up when it is redrawing on demand
+	virtual void mouseButtonCallback(int button, int action, int mods) override
+	{
+		requestRedraw();
+	}
+
+	virtual void scrollCallback(double xoffset, double yoffset) override
+	{
+		requestRedraw();
+	}
+
+	virtual void windowSizeCallback(int width, int height) override
+	{
+		glViewport(0, 0, width, height);
+		requestRedraw();
+	}
 
 private:
 	ShaderProgram &shader;
 	CPU_Geometry &cGeom;
 	GPU_Geometry &gGeom; // add references so that we can update the geometry
+	Window &window;		 // for the size, to turn cursor positions into NDC
 };
 
 class MyCallbacks2 : public CallbackInterface
@@ -281,6 +740,13 @@ int main()
 	// WINDOW
 	glfwInit();													// MUST call this first to set up environment (There is a terminate pair after the loop)
 	Window window(800, 800, "CPSC 453 Assignment 1: Fractals"); // Can set callbacks at construction if desired
+	if (GLFWmonitor *monitor = glfwGetPrimaryMonitor())
+	{ // a frame that misses a vsync takes two refresh periods, the budget sits in between
+		if (const GLFWvidmode *mode = glfwGetVideoMode(monitor))
+		{
+			frameStats.budgetMs = 1.5 * 1000.0 / std::max(mode->refreshRate, 1);
+		}
+	}
 
 	// GLDebug::enable(); // ON Submission you may comments this out to avoid unnecessary prints to the console
 
@@ -299,27 +765,182 @@ int main()
 		AssetPath::Instance()->Get("shaders/basic.frag")); // Render pipeline we will use (You can use more than one!)
 
 	// GEOMETRY
-	CPU_Geometry cGeom; // Just a collection of vectors with geometry information
+	CPU_Geometry cGeom(&geometryArena); // Just a collection of vectors with geometry information
 	GPU_Geometry gGeom; // A wrapper managing VBOs, presumably
 
 	// CALLBACKS
-	std::shared_ptr<MyCallbacks> callback_ptr = std::make_shared<MyCallbacks>(shader, cGeom, gGeom); // Class To capture input events
+	std::shared_ptr<MyCallbacks> callback_ptr = std::make_shared<MyCallbacks>(shader, cGeom, gGeom, window); // Class To capture input events
 	// std::shared_ptr<MyCallbacks2> callback2_ptr = std::make_shared<MyCallbacks2>(); // not used
 	window.setCallbacks(callback_ptr); // when a callback occurs, the window shall call the callback_ptr
+	// not in CallbackInterface: the window was uncovered (its contents may be gone) or gained/lost focus
+	glfwSetWindowRefreshCallback(window.getGLFWwindow(), [](GLFWwindow *) { requestRedraw(1); });
+	// ImGui installed its own focus callback, it still has to be called
+	static GLFWwindowfocusfun imguiFocusCallback = nullptr;
+	imguiFocusCallback = glfwSetWindowFocusCallback(window.getGLFWwindow(), [](GLFWwindow *w, int focused)
+	{
+		if (imguiFocusCallback != nullptr)
+		{
+			imguiFocusCallback(w, focused);
+		}
+		requestRedraw();
+	});
 
 	updateFractal(cGeom, gGeom); // initialize the initial fractal geometry (default: Sierpinski)
 
+	// FOREST
+	// instanced trees need their own shader for the per-instance offset/scale/tint attributes
+	ShaderProgram forestShader(
+		AssetPath::Instance()->Get("shaders/forest.vert"),
+		AssetPath::Instance()->Get("shaders/basic.frag"));
+	Forest forest(fractalConfigs[TreeForest].maxIteration); // generates the tree once per depth
+	int forestTrees = 10000;
+	float forestLodPixels = 2.0f; // how long (in pixels) the finest branch of a tree may get before adding a level
+	ForestCamera forestCamera;
+	forest.scatter(forestTrees);
+
+	// SHADER COLOURS
+	// basic.vert/basic.frag with the colour rules built in, for geometry uploaded without colours
+	ShaderProgram derivedColorShader(
+		AssetPath::Instance()->Get("shaders/derived_color.vert"),
+		AssetPath::Instance()->Get("shaders/derived_color.frag"));
+	Palettes palettes; // a palette change is only a uniform change for derived_color.frag
+	std::vector<const char *> paletteNames = {"Fractal Colours"};
+	for (int i = 0; i < Palettes::count(); i++)
+	{
+		paletteNames.push_back(Palettes::name(i));
+	}
+
+	// PROCEDURAL
+	// draws without any vertex buffers, but core profile still needs some VAO bound
+	ShaderProgram proceduralShader(
+		AssetPath::Instance()->Get("shaders/procedural.vert"),
+		AssetPath::Instance()->Get("shaders/basic.frag"));
+	VertexArray emptyVao;
+
+	// INSTANCED
+	ShaderProgram instancedShader(
+		AssetPath::Instance()->Get("shaders/sierpinski_instanced.vert"),
+		AssetPath::Instance()->Get("shaders/basic.frag"));
+	InstancedSierpinski instancedSierpinski;
+
+	// GPU SUBDIVISION
+	GpuSubdivision gpuSubdivision;
+
+	// IMAGE SPACE
+	ImageSierpinski imageSierpinski;
+
+	// HOLES
+	// basic.vert, with the leaves' colours worked out per pixel for the root triangle the holes are drawn over
+	ShaderProgram regionsShader(
+		AssetPath::Instance()->Get("shaders/basic.vert"),
+		AssetPath::Instance()->Get("shaders/sierpinski_regions.frag"));
+
+	// PER PIXEL
+	ShaderProgram perPixelShader(
+		AssetPath::Instance()->Get("shaders/fullscreen.vert"),
+		AssetPath::Instance()->Get("shaders/sierpinski_pixel.frag"));
+
+	// COMPUTE (opt-in, GL 4.3+)
+	std::unique_ptr<ComputeFractals> computeFractals;
+	computeAvailable = computeBackendAvailable();
+	if (computeAvailable)
+	{
+		computeFractals = std::make_unique<ComputeFractals>();
+	}
+	else
+	{
+		Log::info("Compute shader backend unavailable (needs -DFRACTAL_GL46=ON and a GL 4.3 context), using the CPU instead");
+	}
+
+	GpuTimer drawTimer; // GPU time of the fractal draw, shown in the ImGui panel
+
+	// PICKING
+	GPU_Geometry highlightGeom; // the primitive under the cursor, drawn again in white on top
+	int highlightCount = 0;
+	bool cullToTestRect = false;
+
+	// LIVE TREE
+	bool animateTree = false;
+	TreeBenchmark treeBenchmark;
+	auto lastFrameStart = std::chrono::steady_clock::now();
+
+	// RETAINED IMAGE
+	ImageCache imageCache;
+	FractalPassInputs lastPassInputs;
+
+	// ON-DEMAND REDRAW
+	bool wasAnimating = false;
+	int framesDrawn = 0; // since the last readout
+	auto lastActivityCheck = std::chrono::steady_clock::now();
+	double lastCpuSeconds = MemoryStats::cpuSeconds();
+	double drawnPerSecond = 0.0;
+	double cpuPercent = 0.0;
+
 	// RENDER LOOP
 	while (!window.shouldClose())
 	{
-		shader.use(); // Use "this" shader to render
-		gGeom.bind(); // USe "this" VAO (Geometry) on render call
+		if (depthMorph.startTime >= 0.0 && glfwGetTime() - depthMorph.startTime >= depthMorph.duration)
+		{ // the morph is over. Going up, what is uploaded is the new depth. Going down it is depth + 1 collapsed onto
+		  // its ancestors, in its own colours, with 3 times the vertices for drawing, picking and culling
+			if (depthMorph.deepen)
+			{
+				depthMorph.startTime = -1.0;
+			}
+			else
+			{
+				updateFractal(cGeom, gGeom); // the same fractal and depth, so no new morph starts
+			}
+		}
 
-		glEnable(GL_FRAMEBUFFER_SRGB); // Expect Colour to be encoded in sRGB standard (as opposed to RGB)
-		// https://www.viewsonic.com/library/creative-work/srgb-vs-adobe-rgb-which-one-to-use/
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear render screen (all zero) and depth (all max depth)
+		if (redrawOnDemand)
+		{ // the things that change the picture with no event behind them
+			const bool morphPlaying = depthMorph.startTime >= 0.0 && glfwGetTime() - depthMorph.startTime < depthMorph.duration;
+			const bool animating = morphPlaying || animateTree || treeBenchmark.framesLeft > 0 || computePending ||
+								   subdivisionPending || imageBenchmarkPending || pixelBenchmarkPending;
+			if (wasAnimating && !animating)
+			{ // the last frame drawn was still in motion, draw where it stopped
+				requestRedraw(1);
+			}
+			wasAnimating = animating;
+			if (!animating && redrawFrames == 0)
+			{ // nothing new to show, sleep until an event. The callbacks decide if it needs a redraw
+				glfwWaitEvents();
+				continue;
+			}
+			redrawFrames = std::max(redrawFrames - 1, 0);
+		}
+		framesDrawn++;
+
+		// frames drawn and CPU used since the last readout, at least a second ago (longer after sleeping)
+		const double activitySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastActivityCheck).count();
+		if (activitySeconds >= 1.0)
+		{
+			const double cpuSeconds = MemoryStats::cpuSeconds();
+			drawnPerSecond = framesDrawn / activitySeconds;
+			cpuPercent = 100.0 * (cpuSeconds - lastCpuSeconds) / activitySeconds;
+			framesDrawn = 0;
+			lastCpuSeconds = cpuSeconds;
+			lastActivityCheck = std::chrono::steady_clock::now();
+		}
+
+		auto frameStart = std::chrono::steady_clock::now();
+		frameStats.beginFrame();
+		glStateFrame = GLState::counters();
+		GLState::resetCounters();
+		if (treeBenchmark.framesLeft > 0)
+		{ // the previous frame is finished (swapped), record it
+			treeBenchmark.frameMs.push_back(std::chrono::duration<double, std::milli>(frameStart - lastFrameStart).count());
+			treeBenchmark.generateMs.push_back(lastGenerateMs);
+			if (--treeBenchmark.framesLeft == 0)
+			{
+				reportTreeBenchmark(treeBenchmark, fractalConfigs[Tree].currentIteration);
+				animateTree = false;
+			}
+		}
+		lastFrameStart = frameStart;
 
 		// --- Start a new ImGui frame ---
+		frameStats.beginPhase(FramePhase::Ui);
 		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
@@ -328,7 +949,9 @@ int main()
 
 		if (!io.WantCaptureKeyboard && !io.WantCaptureMouse)
 		{ // Only grab events if ImGui doesn't need them, because it handles them as a priority
+			frameStats.beginPhase(FramePhase::Events);
 			glfwPollEvents();
+			frameStats.beginPhase(FramePhase::Ui);
 		}
 
 		// Create a window called "Control Fractals" --- for user to manage
@@ -343,27 +966,477 @@ int main()
 		FractalConfig &config = fractalConfigs[currentFractal]; // find the entry in the struct array
 
 		// Add a slider so that we can change the iteration depth
-		if (ImGui::SliderInt("Iteration Depth", &config.currentIteration, 0, config.maxIteration))
+		if (ImGui::SliderInt("Iteration Depth", &config.currentIteration, 0, depthLimit()))
 		{
 			updateFractal(cGeom, gGeom); // update the fractal based on the new type and current iteration
 		}
 
+		// where the vertices are generated, and what that costs in time and memory
+		if (currentFractal != TreeForest)
+		{
+			if (ImGui::Combo("Geometry Source", reinterpret_cast<int *>(&geometrySource), geometrySourceNames, IM_ARRAYSIZE(geometrySourceNames)))
+			{
+				MemoryStats::resetPeak(); // so the peak shows this path only
+				updateFractal(cGeom, gGeom);
+			}
+			if (activeSource() == SubdivideOnGpu)
+			{
+				if (ImGui::SliderInt("GPU Levels", &gpuLevels, 1, 4))
+				{
+					updateFractal(cGeom, gGeom);
+				}
+				ImGui::Text("CPU depth %d, GPU levels %d", config.currentIteration - subdivisionLevels, subdivisionLevels);
+			}
+			if ((activeSource() == UploadFromCpu || activeSource() == MapIntoGpu) && ImGui::Checkbox("Colours In Shader", &shaderColors))
+			{ // drops the colour VBO, the shader works the colours out
+				updateFractal(cGeom, gGeom);
+			}
+			if (currentFractal == SierpinskiTriangle && (activeSource() == UploadFromCpu || activeSource() == MapIntoGpu) &&
+				ImGui::Checkbox("Draw The Holes Instead", &sierpinskiHoles))
+			{ // about half the triangles, the root plus a hole in the background colour per subdivision
+				updateFractal(cGeom, gGeom);
+			}
+			if (currentFractal == LevyCurve && activeSource() == UploadFromCpu)
+			{
+				if (ImGui::Checkbox("Remove Overlapping Segments", &levyDedup))
+				{
+					updateFractal(cGeom, gGeom);
+				}
+				if (dedupActive())
+				{
+					ImGui::Text("%zu unique of %zu segments (%.3f ms)", dedupStats.unique, dedupStats.emitted, dedupStats.ms);
+				}
+				if (ImGui::Button("Log Overlap Per Depth"))
+				{
+					reportSegmentOverlap(fractalConfigs[LevyCurve].maxIteration);
+				}
+			}
+			if (shaderColorsActive())
+			{ // the combo's first entry is the fractal's own colours (-1), then the layers
+				int paletteItem = palette + 1;
+				if (ImGui::Combo("Palette", &paletteItem, paletteNames.data(), static_cast<int>(paletteNames.size())))
+				{
+					palette = paletteItem - 1;
+				}
+			}
+			if (activeSource() == ImageSpace)
+			{
+				ImGui::Text("%d passes over the image, no vertices", imageSierpinski.passes());
+				if (ImGui::Button("Benchmark Against Geometry"))
+				{ // logs depths 6 to 20, takes a moment
+					imageBenchmarkPending = true;
+				}
+			}
+			if (activeSource() == PerPixel)
+			{ // float runs out of precision somewhere past 2^16
+				ImGui::SliderFloat("Zoom (log2)", &pixelViewZoomLog2, 0.0f, 16.0f);
+				ImGui::DragFloat2("View Centre", &pixelViewCentre.x, 0.01f / std::exp2(pixelViewZoomLog2), -1.0f, 1.0f, "%.6f");
+				if (ImGui::Button("Compare With Triangles"))
+				{ // logs time and differing pixels for every depth
+					pixelBenchmarkPending = true;
+				}
+			}
+			if (geometrySource == ComputeShader && !computeAvailable)
+			{
+				ImGui::Text("No compute shaders (needs -DFRACTAL_GL46=ON and GL 4.3), using the CPU");
+			}
+			ImGui::Text("Generate: %.3f ms, upload: %.3f ms (%zu bytes)", lastGenerateMs, lastUploadMs, lastUploadBytes);
+			ImGui::Text("RSS: %.1f MB, peak: %.1f MB", MemoryStats::currentRss() / 1048576.0, MemoryStats::peakRss() / 1048576.0);
+
+			// the arena behind cGeom, changes apply from the next regeneration
+			ImGui::Checkbox("Reuse Geometry Memory", &arenaEnabled);
+			ImGui::SameLine();
+			ImGui::Checkbox("Huge Pages", &arenaHugePages);
+			ImGui::Text("Arena: %.1f of %.1f MB%s, %zu allocations, %zu from the heap", geometryArena.used() / 1048576.0,
+						geometryArena.capacity() / 1048576.0, geometryArena.hugePages() ? " (huge pages)" : "",
+						geometryArena.stats().allocations, geometryArena.stats().heapAllocations);
+			if (ImGui::Button("Benchmark Depth Changes"))
+			{ // logs heap vs arena, takes a moment
+				DepthChangeWorkload workload;
+				for (int fractal = SierpinskiTriangle; fractal <= Tree; fractal++)
+				{
+					workload.maxDepth[fractal] = fractalConfigs[fractal].maxIteration;
+				}
+				workload.treeParams = treeParams;
+				workload.order = primitiveOrder;
+				workload.orderName = curveNames[static_cast<int>(primitiveOrder)];
+				reportDepthChangeBenchmark(workload, arenaHugePages);
+			}
+		}
+
+		// primitive order, and what it does to draw time and culling
+		if (cpuGeometryAvailable() && ImGui::Combo("Primitive Order", reinterpret_cast<int *>(&primitiveOrder), curveNames, IM_ARRAYSIZE(curveNames)))
+		{
+			updateFractal(cGeom, gGeom);
+		}
+		ImGui::Text("Draw (GPU): %.3f ms", drawTimer.lastMs());
+		if (primitiveOrder != CurveType::Recursion && currentFractal != TreeForest && cpuGeometryAvailable())
+		{
+			ImGui::Text("Reorder: %.3f ms", lastReorderMs);
+			ImGui::Text("Cull top-right quarter, scan: %.1f us (%zu primitives)", cullStats.scanUs, cullStats.scanPrimitives);
+			ImGui::Text("Cull top-right quarter, curve: %.1f us (%zu ranges, %zu primitives)", cullStats.rangesUs, cullStats.ranges.size(), cullStats.rangePrimitives);
+			ImGui::Checkbox("Draw Only The Culled Ranges", &cullToTestRect);
+		}
+
+		// picking under the cursor (it needs the vertices on the CPU)
+		if (currentFractal != TreeForest && cpuGeometryAvailable())
+		{
+			ImGui::Checkbox("Pick Under Cursor", &pickingEnabled);
+			if (pickingEnabled && picked.primitive >= 0)
+			{
+				std::string path;
+				for (int child : picked.path)
+				{
+					path += std::to_string(child) + " ";
+				}
+				ImGui::Text("Picked primitive %d in %.2f us, path: %s", picked.primitive, lastPickUs, path.c_str());
+			}
+		}
+
+		// depth changes blend smoothly on the GPU instead of jumping
+		ImGui::Checkbox("Morph Depth Changes", &depthMorph.enabled);
+		if (depthMorph.enabled)
+		{
+			ImGui::SliderFloat("Morph Duration", &depthMorph.duration, 0.05f, 3.0f);
+		}
+
+		if (currentFractal == Tree)
+		{ // live shape controls, any change re-evaluates the whole tree
+			bool changed = false;
+			changed |= ImGui::SliderFloat("Branch Angle", &treeParams.angle, 0.0f, 90.0f);
+			changed |= ImGui::SliderFloat("Branch Scale", &treeParams.scale, 0.1f, 0.7f);
+			changed |= ImGui::SliderFloat("Branch Point", &treeParams.branchPoint, 0.0f, 1.0f);
+			ImGui::Checkbox("Animate Angle", &animateTree);
+
+			if (ImGui::Button("Benchmark Frame Time") && treeBenchmark.framesLeft == 0)
+			{ // the worst case: animate the deepest tree for a few seconds
+				config.currentIteration = config.maxIteration;
+				animateTree = true;
+				treeBenchmark = TreeBenchmark();
+				treeBenchmark.framesLeft = 300;
+			}
+
+			if (animateTree)
+			{ // sweep the angle back and forth, re-evaluating the tree every frame
+				treeParams.angle = 45.0f + 40.0f * static_cast<float>(std::sin(glfwGetTime()));
+				changed = true;
+			}
+			if (changed)
+			{
+				updateFractal(cGeom, gGeom);
+			}
+			ImGui::Text("Generation: %.3f ms (%d branches)", lastGenerateMs, drawCount / 2);
+		}
+
+		if (currentFractal == TreeForest)
+		{ // the forest is made of instances, so it gets its own camera and LOD controls
+			if (ImGui::SliderInt("Tree Count", &forestTrees, 1000, 50000))
+			{
+				forest.scatter(forestTrees);
+			}
+			ImGui::SliderFloat("LOD Pixels", &forestLodPixels, 0.5f, 16.0f);
+			ImGui::SliderFloat("Camera Zoom", &forestCamera.zoom, 0.02f, 4.0f);
+			ImGui::SliderFloat2("Camera Position", &forestCamera.position.x, -0.5f * forest.extent(), 0.5f * forest.extent());
+
+			ImGui::Text("Visible trees: %d / %d", forest.visibleCount(), forest.treeCount());
+			ImGui::Text("Vertices submitted: %lld", forest.submittedVertices());
+			for (size_t depth = 0; depth < forest.batchSizes().size(); depth++)
+			{
+				if (forest.batchSizes()[depth] > 0)
+				{
+					ImGui::Text("  depth %zu: %d trees", depth, forest.batchSizes()[depth]);
+				}
+			}
+		}
+
+		// the fractal drawn once and copied while it doesn't change
+		if (ImGui::Checkbox("Retain Fractal Image", &retainImage))
+		{
+			imageCache.invalidate();
+		}
+		if (retainImage)
+		{
+			ImGui::SameLine();
+			ImGui::Text("(%zu redraws)", imageCache.captures());
+		}
+
+		// on demand, an idle window sleeps instead of drawing the same picture again
+		ImGui::Checkbox("Redraw Only On Changes", &redrawOnDemand);
+		ImGui::Text("%.1f frames/s drawn, %.0f%% CPU (of one core)", drawnPerSecond, cpuPercent);
+
+		// CPU time per frame over the last 600 frames, by phase. Frames over the budget are logged as hitches
+		if (ImGui::CollapsingHeader("Frame Times"))
+		{
+			const FrameSummary frames = frameStats.summary();
+			ImGui::Text("Frame: p50 %.2f, p95 %.2f, p99 %.2f, max %.2f ms", frames.p50, frames.p95, frames.p99, frames.max);
+			for (int phase = 0; phase < static_cast<int>(FramePhase::Count); phase++)
+			{
+				const FrameSummary phaseTimes = frameStats.summary(static_cast<FramePhase>(phase));
+				ImGui::Text("  %-8s p50 %.2f, p95 %.2f, max %.2f ms", framePhaseName(static_cast<FramePhase>(phase)), phaseTimes.p50,
+							phaseTimes.p95, phaseTimes.max);
+			}
+			float budget = static_cast<float>(frameStats.budgetMs);
+			if (ImGui::SliderFloat("Hitch Budget (ms)", &budget, 4.0f, 100.0f))
+			{
+				frameStats.budgetMs = budget;
+			}
+			ImGui::Text("%zu hitches in %zu frames", frameStats.hitches(), frameStats.frames());
+
+			ImGui::Checkbox("Save CSV On Exit", &saveFrameCsv);
+			ImGui::SameLine();
+			ImGui::Text("(%s)", frameCsvPath);
+		}
+
+		// State changes the wrappers made last frame, and the ones skipped because the state was already set
+		if (ImGui::CollapsingHeader("GL State"))
+		{
+			ImGui::Text("%zu changes made, %zu skipped", glStateFrame.totalIssued(), glStateFrame.totalSkipped());
+			for (int kind = 0; kind < static_cast<int>(GLState::Kind::Count); kind++)
+			{
+				ImGui::Text("  %-12s %4zu made, %4zu skipped", GLState::kindName(static_cast<GLState::Kind>(kind)),
+							glStateFrame.issued[kind], glStateFrame.skipped[kind]);
+			}
+			if (GLState::validationAvailable())
+			{ // debug builds only, every skipped change asks the driver first
+				bool validating = GLState::validation();
+				if (ImGui::Checkbox("Validate Against glGet", &validating))
+				{
+					GLState::setValidation(validating);
+				}
+				ImGui::SameLine();
+				if (ImGui::Button("Check Now"))
+				{
+					Log::info("GL_STATE {} mismatches", GLState::validate());
+				}
+				ImGui::Text("%zu mismatches last frame", glStateFrame.mismatches);
+			}
+		}
+
 		ImGui::End(); // End the window
 
+		frameStats.beginPhase(FramePhase::Generate);
+		if (pickPending && pickingEnabled && currentFractal != TreeForest)
+		{ // segments can be picked within a few pixels of them, triangles have to contain the cursor
+			auto pickStart = std::chrono::steady_clock::now();
+			picked = pickIndex.pick(cGeom, cursorNdc, 12.0f / std::max(1, window.getWidth()));
+			lastPickUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - pickStart).count();
+			pickPending = false;
+
+			highlightCount = 0;
+			if (picked.primitive >= 0)
+			{
+				highlightCount = ordering.vertsPerPrimitive; // set by every updateFractal, even without reordering
+				auto first = cGeom.verts.begin() + picked.primitive * highlightCount;
+				highlightGeom.setVerts(std::pmr::vector<glm::vec3>(first, first + highlightCount));
+				highlightGeom.setCols(std::pmr::vector<glm::vec3>(highlightCount, glm::vec3(1.0f)));
+			}
+		}
+
+		if (activeSource() == ComputeShader && computePending)
+		{ // one dispatch per level (this times submitting them, not the GPU work)
+			auto generateStart = std::chrono::steady_clock::now();
+			computeFractals->generate(static_cast<int>(currentFractal), fractalConfigs[currentFractal].currentIteration, treeParams);
+			lastGenerateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generateStart).count();
+			drawCount = computeFractals->vertexCount();
+			computePending = false;
+			sceneVersion++;
+		}
+		if (activeSource() == SubdivideOnGpu && subdivisionPending)
+		{ // upload the coarse fractal and run the subdivision passes (this times submitting them, not the GPU work)
+			auto uploadStart = std::chrono::steady_clock::now();
+			gpuSubdivision.run(cGeom, fractalConfigs[currentFractal].drawingMode, subdivisionLevels);
+			lastUploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+			drawCount = gpuSubdivision.vertexCount();
+			subdivisionPending = false;
+			sceneVersion++;
+		}
+
+		if (imageBenchmarkPending)
+		{ // before the clear, whatever it draws is overwritten
+			reportImageSpaceBenchmark(imageSierpinski, shader, imageSpaceMaxDepth);
+			imageBenchmarkPending = false;
+			frameStats.note("image space benchmark");
+		}
+		if (pixelBenchmarkPending)
+		{
+			reportPerPixelBenchmark(perPixelShader, emptyVao, shader, perPixelMaxDepth);
+			pixelBenchmarkPending = false;
+			frameStats.note("per pixel benchmark");
+		}
+
 		shader.use(); // Use "this" shader to render
 		gGeom.bind(); // Use "this" VAO (Geometry) on render call
 
-		glEnable(GL_FRAMEBUFFER_SRGB); // Expect Colour to be encoded in sRGB standard (as opposed to RGB)
+		GLState::enable(GL_FRAMEBUFFER_SRGB); // Expect Colour to be encoded in sRGB standard (as opposed to RGB)
+		// https://www.viewsonic.com/library/creative-work/srgb-vs-adobe-rgb-which-one-to-use/
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear render screen (all zero) and depth (all max depth)
-		glDrawArrays(fractalConfigs[currentFractal].drawingMode, 0, static_cast<GLsizei>(cGeom.verts.size()));
-		// this is the draw call, works by referencing the struct for drawing mode and the size of the vertices, which is casted to GLsizei because it is an unsigned int
-		glDisable(GL_FRAMEBUFFER_SRGB); // disable sRGB for the imgui
+		if (activeSource() == Instanced)
+		{ // only regenerates when the depth changed
+			instancedSierpinski.update(instancedDepth);
+			lastGenerateMs = instancedSierpinski.generateMs();
+			lastUploadMs = instancedSierpinski.uploadMs();
+			lastUploadBytes = instancedSierpinski.uploadBytes();
+		}
+		frameStats.beginPhase(FramePhase::Draw);
+		drawTimer.begin();
+		FractalPassInputs passInputs;
+		passInputs.sceneVersion = sceneVersion;
+		glGetIntegerv(GL_VIEWPORT, &passInputs.viewport.x);
+		passInputs.palette = shaderColorsActive() ? palette : -1;
+		passInputs.morph = morphValue();
+		passInputs.culledRanges = cullToTestRect;
+		if (activeSource() == PerPixel)
+		{
+			passInputs.pixelViewCentre = pixelViewCentre;
+			passInputs.pixelViewZoomLog2 = pixelViewZoomLog2;
+		}
+		if (currentFractal == TreeForest)
+		{
+			passInputs.forestPosition = forestCamera.position;
+			passInputs.forestZoom = forestCamera.zoom;
+			passInputs.forestTrees = forestTrees;
+			passInputs.forestLodPixels = forestLodPixels;
+		}
+		const bool imageReusable = retainImage && imageCache.valid() && passInputs == lastPassInputs;
+		if (!imageReusable)
+		{ // the whole pass, into the retained image when there is one. Costs as much as the fractal has primitives
+			if (retainImage)
+			{
+				imageCache.beginCapture();
+			}
+			if (currentFractal == TreeForest)
+			{
+				// cull, pick each tree's depth and upload the instances, then one instanced draw per depth
+				forest.update(forestCamera, window.getSize(), config.currentIteration, forestLodPixels);
+				forestShader.use();
+				glUniform2f(glGetUniformLocation(forestShader, "cameraPos"), forestCamera.position.x, forestCamera.position.y);
+				glUniform1f(glGetUniformLocation(forestShader, "cameraZoom"), forestCamera.zoom);
+				forest.draw();
+			}
+			else
+			{
+				glUniform1f(glGetUniformLocation(shader, "morph"), morphValue()); // only the uniform changes while a morph plays
+				if (shaderColorsActive())
+				{ // flat Sierpinski colours come from the first corner (p1), like the CPU rule
+					derivedColorShader.use();
+					glUniform1i(glGetUniformLocation(derivedColorShader, "fractal"), static_cast<int>(currentFractal));
+					glUniform1f(glGetUniformLocation(derivedColorShader, "morph"), morphValue());
+					glUniform1i(glGetUniformLocation(derivedColorShader, "maxDepth"), fractalConfigs[Tree].maxIteration);
+					glUniform1i(glGetUniformLocation(derivedColorShader, "palette"), palette);
+					glUniform1i(glGetUniformLocation(derivedColorShader, "palettes"), 0);
+					palettes.bind(0);
+					glProvokingVertex(GL_FIRST_VERTEX_CONVENTION);
+				}
+				if (activeSource() == PerPixel)
+				{
+					drawPerPixelSierpinski(perPixelShader, emptyVao, config.currentIteration, pixelViewCentre, std::exp2(pixelViewZoomLog2));
+				}
+				else if (activeSource() == ImageSpace)
+				{ // rebuilt every frame, depth + 1 passes into the offscreen targets, then one onto the window
+					imageSierpinski.render(config.currentIteration);
+					imageSierpinski.draw();
+				}
+				else if (activeSource() == ComputeShader)
+				{
+					computeFractals->draw(fractalConfigs[currentFractal].drawingMode);
+				}
+				else if (activeSource() == SubdivideOnGpu)
+				{
+					gpuSubdivision.draw(fractalConfigs[currentFractal].drawingMode);
+				}
+				else if (activeSource() == Instanced)
+				{
+					instancedShader.use();
+					instancedSierpinski.draw();
+				}
+				else if (activeSource() == VertexShader)
+				{ // no buffers, the shader gets the fractal, its depth and the tree shape and works out the rest
+					const float angle = glm::radians(treeParams.angle);
+					proceduralShader.use();
+					emptyVao.bind();
+					glUniform1i(glGetUniformLocation(proceduralShader, "fractal"), static_cast<int>(currentFractal));
+					glUniform1i(glGetUniformLocation(proceduralShader, "depth"), proceduralDepth);
+					glUniform1f(glGetUniformLocation(proceduralShader, "cosA"), std::cos(angle));
+					glUniform1f(glGetUniformLocation(proceduralShader, "sinA"), std::sin(angle));
+					glUniform1f(glGetUniformLocation(proceduralShader, "scale"), treeParams.scale);
+					glUniform1f(glGetUniformLocation(proceduralShader, "branchPoint"), treeParams.branchPoint);
+					glUniform1f(glGetUniformLocation(proceduralShader, "morph"), morphValue());
+					glDrawArrays(fractalConfigs[currentFractal].drawingMode, 0, drawCount);
+				}
+				else if (cullToTestRect && primitiveOrder != CurveType::Recursion && cpuGeometryAvailable())
+				{ // the culled rectangle is a handful of contiguous runs, one multi-draw covers them all
+					std::vector<GLint> firsts;
+					std::vector<GLsizei> counts;
+					for (const auto &range : cullStats.ranges)
+					{
+						firsts.push_back(range.first);
+						counts.push_back(range.second);
+					}
+					glMultiDrawArrays(fractalConfigs[currentFractal].drawingMode, firsts.data(), counts.data(), static_cast<GLsizei>(firsts.size()));
+				}
+				else if (holesActive())
+				{ // the root first, coloured per pixel, then the holes over it with their own (background) colour
+					GLint viewport[4];
+					glGetIntegerv(GL_VIEWPORT, viewport);
+					regionsShader.use();
+					glUniform1i(glGetUniformLocation(regionsShader, "depth"), config.currentIteration);
+					glUniform4f(glGetUniformLocation(regionsShader, "viewport"), viewport[0], viewport[1], viewport[2], viewport[3]);
+					glUniform1f(glGetUniformLocation(regionsShader, "morph"), 1.0f);
+					glDrawArrays(GL_TRIANGLES, 0, 3);
+					shader.use();
+					glDrawArrays(GL_TRIANGLES, 3, drawCount - 3);
+				}
+				else
+				{
+					glDrawArrays(fractalConfigs[currentFractal].drawingMode, 0, drawCount);
+					// this is the draw call, works by referencing the struct for drawing mode and the size of the vertices, which is casted to GLsizei because it is an unsigned int
+				}
+				glProvokingVertex(GL_LAST_VERTEX_CONVENTION); // back to the default
+			}
+			if (retainImage)
+			{
+				imageCache.endCapture();
+			}
+			lastPassInputs = passInputs;
+		}
+		if (retainImage)
+		{ // costs as much as the window has pixels, whatever was drawn into it
+			imageCache.blit();
+		}
+		drawTimer.end();
+
+		if (pickingEnabled && highlightCount > 0 && currentFractal != TreeForest)
+		{ // the highlight has its own (white) colours
+			shader.use();
+			highlightGeom.bind();
+			glUniform1f(glGetUniformLocation(shader, "morph"), 1.0f);
+			glDrawArrays(fractalConfigs[currentFractal].drawingMode, 0, highlightCount);
+		}
+		GLState::disable(GL_FRAMEBUFFER_SRGB); // disable sRGB for the imgui
 
 		// End ImGui frame
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData()); // this renders the imgui data before the swap buffers
+		if (GLState::validation())
+		{ // catches GL calls made around the cache, the next frame's changes would be skipped wrongly
+			GLState::validate();
+		}
 
+		frameStats.beginPhase(FramePhase::Swap);
 		window.swapBuffers(); // Swap the buffers while displaying the previous
+		frameStats.endFrame();
+	}
+
+	if (saveFrameCsv)
+	{
+		if (frameStats.writeCsv(frameCsvPath))
+		{
+			Log::info("Frame times of {} frames written to {}", frameStats.frames(), frameCsvPath);
+		}
+		else
+		{
+			Log::error("Couldn't write the frame times to {}", frameCsvPath);
+		}
 	}
 
 	// good practice is to clean up the ImGui context
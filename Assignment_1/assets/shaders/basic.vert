@@ -1,10 +1,13 @@
 #version 330 core
 layout (location = 0) in vec3 pos;
 layout (location = 1) in vec3 color;
+layout (location = 2) in vec3 ancestorPos; // where this vertex was one depth up (depth morph only)
+
+uniform float morph; // 0 draws the ancestors (depth n), 1 the vertices themselves (depth n+1)
 
 out vec3 fragColor;
 
 void main() {
-	gl_Position = vec4(pos, 1.0);
+	gl_Position = vec4(mix(ancestorPos, pos, morph), 1.0);
 	fragColor = color;
 }
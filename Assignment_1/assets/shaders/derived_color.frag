@@ -0,0 +1,23 @@
+#version 330 core
+out vec4 color;
+
+flat in vec3 flatColor;
+in vec3 smoothColor;
+flat in float flatParam;
+in float smoothParam;
+
+uniform int fractal;
+uniform int palette; // a layer of palettes, or -1 for the fractal's own colours
+uniform sampler1DArray palettes;
+
+const float entries = 256.0; // Palettes::entries
+
+void main() {
+	if (palette < 0) {
+		color = vec4(fractal == 0 ? flatColor : smoothColor, 1.0);
+		return;
+	}
+	// 0 and 1 land on the centres of the first and last entries, not their outer edges
+	float t = clamp(fractal == 0 ? flatParam : smoothParam, 0.0, 1.0);
+	color = vec4(texture(palettes, vec2((t * (entries - 1.0) + 0.5) / entries, float(palette))).rgb, 1.0);
+}
@@ -0,0 +1,31 @@
+#version 330 core
+// basic.vert for fractals uploaded without colours (see VertexColors in Geometry.h).
+// The colour rules of Fractals.cpp are worked out here from what the vertex already has
+layout (location = 0) in vec3 pos;
+layout (location = 2) in vec3 ancestorPos; // where this vertex was one depth up (depth morph only)
+layout (location = 3) in float shade; // Levy curve: t * 65535, tree: depth of the branch, Sierpinski: unused
+
+uniform int fractal; // 0 Sierpinski triangle, 1 Levy curve, 2 tree (the FractalTypes order)
+uniform float morph; // 0 draws the ancestors (depth n), 1 the vertices themselves (depth n+1)
+uniform int maxDepth; // the deepest tree, its branches get the end of a palette
+
+flat out vec3 flatColor; // one colour for the whole triangle, from its first vertex (drawn with GL_FIRST_VERTEX_CONVENTION)
+out vec3 smoothColor;
+// the same, as a scalar in [0, 1] for derived_color.frag to look up in a palette
+flat out float flatParam;
+out float smoothParam;
+
+void main() {
+	gl_Position = vec4(mix(ancestorPos, pos, morph), 1.0);
+
+	// the Sierpinski triangle is coloured by its first corner p1, which is this vertex for the provoking one
+	flatColor = vec3((pos.x + 1.0) / 2.0, (pos.y + 1.0) / 2.0, 0.5);
+	flatParam = (pos.x + pos.y + 1.0) / 2.0; // along the diagonal, the corners lie in [-0.5, 0.5]
+	if (fractal == 1) {
+		smoothParam = shade / 65535.0;
+		smoothColor = mix(vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), smoothParam);
+	} else {
+		smoothParam = shade / float(max(maxDepth, 1));
+		smoothColor = (shade <= 3.0) ? vec3(0.4, 0.3, 0.2) : vec3(0.13, 0.55, 0.13);
+	}
+}
@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec3 instanceTransform; // xy offset, z scale
+layout (location = 3) in vec3 instanceTint;
+
+uniform vec2 cameraPos;
+uniform float cameraZoom;
+
+out vec3 fragColor;
+
+void main() {
+	vec2 world = instanceTransform.xy + pos.xy * instanceTransform.z;
+	gl_Position = vec4((world - cameraPos) * cameraZoom, 0.0, 1.0);
+	fragColor = color * instanceTint;
+}
@@ -0,0 +1,9 @@
+#version 330 core
+// One triangle covering the whole viewport, from gl_VertexID alone (3 vertices, empty VAO).
+// Unlike two triangles, there is no seam along a diagonal where pixels get shaded twice
+out vec2 ndc;
+
+void main() {
+	ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0; // (-1,-1) (3,-1) (-1,3)
+	gl_Position = vec4(ndc, 0.0, 1.0);
+}
@@ -0,0 +1,38 @@
+#version 330 core
+// The colour of a triangle comes from its first corner p1, c = ((p1.x + 1) / 2, (p1.y + 1) / 2, 0.5) as in
+// Fractals.cpp. A copy moves p1 to (p1 + corner) / 2, which makes c.rg = c.rg / 2 + (1 + corner) / 4.
+// Alpha 0 marks the empty parts of the image
+out vec4 color;
+
+in vec2 texCoord;
+in vec2 ndc;
+flat in vec2 corner;
+
+uniform int stage;
+uniform sampler2D image;
+
+void main() {
+	if (stage == 0) {
+		// the root triangle (-0.5,-0.5) (0.5,-0.5) (0,0.5), coloured by its first corner
+		if (ndc.y < -0.5 || ndc.y > 0.5 - 2.0 * abs(ndc.x)) {
+			discard;
+		}
+		color = vec4(0.25, 0.25, 0.5, 1.0);
+		return;
+	}
+
+	// a copy puts every pixel centre exactly on the corner between four texels of the last image, where
+	// nearest filtering may go either way (and lose an edge every pass). Always taking the lower left
+	// one is the same every pass and on every driver. In the show stage the centres line up, -0.25 is harmless
+	ivec2 size = textureSize(image, 0);
+	ivec2 texel = clamp(ivec2(floor(texCoord * vec2(size) - 0.25)), ivec2(0), size - 1);
+	vec4 last = texelFetch(image, texel, 0);
+	if (last.a < 0.5) {
+		discard; // the copies overlap, but only ever with each other's empty parts
+	}
+	if (stage == 1) {
+		color = vec4(last.rg / 2.0 + (1.0 + corner) / 4.0, last.b, 1.0);
+	} else {
+		color = vec4(last.rgb, 1.0);
+	}
+}
@@ -0,0 +1,20 @@
+#version 330 core
+// The quads of ImageSierpinski, without any vertex buffers: gl_VertexID 0-3 are the corners of a
+// triangle strip over the whole image. In the copy stage every instance is one of the three
+// half-scale copies, x -> (x + corner) / 2 for its corner of the root triangle
+
+uniform int stage; // 0 seed (the depth 0 triangle), 1 copy, 2 show
+
+const vec2 corners[3] = vec2[3](vec2(-0.5, -0.5), vec2(0.5, -0.5), vec2(0.0, 0.5));
+
+out vec2 texCoord; // where in the last image
+out vec2 ndc;      // where in the new one
+flat out vec2 corner;
+
+void main() {
+	vec2 quad = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0; // (-1,-1) (1,-1) (-1,1) (1,1)
+	texCoord = quad * 0.5 + 0.5;
+	corner = corners[gl_InstanceID];
+	ndc = (stage == 1) ? (quad + corner) / 2.0 : quad;
+	gl_Position = vec4(ndc, 0.0, 1.0);
+}
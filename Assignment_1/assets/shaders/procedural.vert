@@ -0,0 +1,139 @@
+#version 330 core
+// Rebuilds the fractals from gl_VertexID alone, drawn with an empty VAO (no vertex buffers at all).
+// Every fractal is a complete recursion written out depth first, so the index of a primitive in
+// base 3 (base 2 for the Levy curve) lists the child taken at every level, root first. Walking
+// those digits repeats the steps of the CPU generators in Fractals.cpp with the same float
+// operations, so the result matches the uploaded geometry.
+
+uniform int fractal; // 0 Sierpinski triangle, 1 Levy curve, 2 tree (the FractalTypes order)
+uniform int depth;
+
+// tree shape, precalculated once like the CPU does
+uniform float cosA;
+uniform float sinA;
+uniform float scale;
+uniform float branchPoint;
+
+uniform float morph; // 0 draws the ancestors (depth n), 1 the vertices themselves (depth n+1)
+
+out vec3 fragColor;
+
+int power(int base, int exponent) {
+	int result = 1;
+	for (int i = 0; i < exponent; i++) {
+		result *= base;
+	}
+	return result;
+}
+
+void sierpinski(int vertex, out vec3 pos, out vec3 ancestor, out vec3 color) {
+	int triangle = vertex / 3;
+	int corner = vertex % 3;
+
+	vec3 p[3] = vec3[3](vec3(-0.5, -0.5, 0.0), vec3(0.5, -0.5, 0.0), vec3(0.0, 0.5, 0.0));
+	vec3 a[3] = p; // the corners one depth up
+	for (int level = depth - 1; level >= 0; level--) {
+		int child = (triangle / power(3, level)) % 3;
+		vec3 mid1 = (p[0] + p[1]) / 2.0;
+		vec3 mid2 = (p[1] + p[2]) / 2.0;
+		vec3 mid3 = (p[0] + p[2]) / 2.0;
+		a = p;
+		if (child == 0) {
+			p = vec3[3](p[0], mid1, mid3);
+		} else if (child == 1) {
+			p = vec3[3](mid1, p[1], mid2);
+		} else {
+			p = vec3[3](mid3, mid2, p[2]);
+		}
+	}
+	pos = p[corner];
+	ancestor = a[corner];
+	color = vec3((p[0].x + 1.0) / 2.0, (p[0].y + 1.0) / 2.0, 0.5);
+}
+
+void levy(int vertex, out vec3 pos, out vec3 ancestor, out vec3 color) {
+	int segment = vertex / 2;
+	int end = vertex % 2;
+
+	vec3 p1 = vec3(-0.5, 0.0, 0.0);
+	vec3 p2 = vec3(0.5, 0.0, 0.0);
+	vec3 a1 = p1;
+	vec3 a2 = p2;
+	for (int level = depth - 1; level >= 0; level--) {
+		vec3 mid = (p1 + p2) / 2.0;
+		vec3 straightMid = mid;
+		vec3 dir = p2 - p1;
+		vec3 perp = vec3(-dir.y, dir.x, 0.0);
+		mid += normalize(perp) * length(dir) * 0.5;
+		if (((segment >> level) & 1) == 0) {
+			a1 = p1;
+			a2 = straightMid;
+			p2 = mid;
+		} else {
+			a1 = straightMid;
+			a2 = p2;
+			p1 = mid;
+		}
+	}
+	pos = (end == 0) ? p1 : p2;
+	ancestor = (end == 0) ? a1 : a2;
+
+	// the CPU halves t at every level, which is exactly the segment's end over 2^depth
+	float t = float(segment + end) / float(1 << depth);
+	color = mix(vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), t);
+}
+
+void tree(int vertex, out vec3 pos, out vec3 ancestor, out vec3 color) {
+	int branch = vertex / 2;
+	int end = vertex % 2;
+
+	// branches are numbered in pre-order: a branch, then everything under its first child, second, third
+	vec3 start = vec3(0.0, -0.8, 0.0);
+	vec3 stop = vec3(0.0, -0.3, 0.0);
+	int level = 0;
+	int remaining = branch;
+	while (remaining > 0) {
+		remaining -= 1;
+		int subtree = (power(3, depth - level) - 1) / 2; // branches under each child
+		int child = remaining / subtree;
+		remaining -= child * subtree;
+
+		vec3 dir = stop - start;
+		float len = length(dir);
+		vec3 unitDir = normalize(dir);
+		float childLength = len * scale;
+		vec3 branchStart = mix(start, stop, branchPoint);
+		if (child == 0) {
+			start = stop;
+			stop = stop + unitDir * childLength;
+		} else if (child == 1) {
+			start = branchStart;
+			stop = branchStart + vec3(unitDir.x * cosA - unitDir.y * sinA, unitDir.x * sinA + unitDir.y * cosA, 0.0) * childLength;
+		} else {
+			start = branchStart;
+			stop = branchStart + vec3(unitDir.x * cosA + unitDir.y * sinA, -unitDir.x * sinA + unitDir.y * cosA, 0.0) * childLength;
+		}
+		level++;
+	}
+	pos = (end == 0) ? start : stop;
+
+	// the newest branches grow out of the point they start at, older branches were already there
+	bool newest = level == depth && level > 0;
+	ancestor = (end == 0 || newest) ? start : stop;
+	color = (level <= 3) ? vec3(0.4, 0.3, 0.2) : vec3(0.13, 0.55, 0.13);
+}
+
+void main() {
+	vec3 pos;
+	vec3 ancestor;
+	vec3 color;
+	if (fractal == 0) {
+		sierpinski(gl_VertexID, pos, ancestor, color);
+	} else if (fractal == 1) {
+		levy(gl_VertexID, pos, ancestor, color);
+	} else {
+		tree(gl_VertexID, pos, ancestor, color);
+	}
+	gl_Position = vec4(mix(ancestor, pos, morph), 1.0);
+	fragColor = color;
+}
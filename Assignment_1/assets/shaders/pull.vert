@@ -0,0 +1,31 @@
+#version 430 core
+// Vertex pulling for the compute backend: no vertex attributes, every vertex is read out of the
+// primitives fractal.comp wrote, by gl_VertexID
+layout (std430, binding = 0) readonly buffer Primitives {
+	vec4 data[];
+};
+
+uniform int fractal; // 0 Sierpinski triangle, 1 Levy curve, 2 tree
+uniform uint first;	 // the first primitive drawn
+
+out vec3 fragColor;
+
+void main() {
+	uint perPrimitive = (fractal == 0) ? 3u : 2u;
+	uint primitive = first + uint(gl_VertexID) / perPrimitive;
+	uint corner = uint(gl_VertexID) % perPrimitive;
+	vec4 a = data[2u * primitive];
+	vec4 b = data[2u * primitive + 1u];
+
+	vec2 pos = (corner == 0u) ? a.xy : ((corner == 1u) ? a.zw : b.xy);
+	gl_Position = vec4(pos, 0.0, 1.0);
+
+	// the same colours as the CPU generators
+	if (fractal == 0) {
+		fragColor = vec3((a.x + 1.0) / 2.0, (a.y + 1.0) / 2.0, 0.5);
+	} else if (fractal == 1) {
+		fragColor = mix(vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), (corner == 0u) ? b.x : b.y);
+	} else {
+		fragColor = (b.x <= 3.0) ? vec3(0.4, 0.3, 0.2) : vec3(0.13, 0.55, 0.13);
+	}
+}
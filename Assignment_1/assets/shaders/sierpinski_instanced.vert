@@ -0,0 +1,11 @@
+#version 330 core
+layout (location = 0) in vec3 pos;		// the base triangle, first corner at the origin and scale 1
+layout (location = 1) in vec3 instance; // per leaf: xy first corner, z scale
+
+out vec3 fragColor;
+
+void main() {
+	gl_Position = vec4(instance.xy + pos.xy * instance.z, 0.0, 1.0);
+	// the same colour generateSierpinskiTriangle gives a leaf, from its first corner
+	fragColor = vec3((instance.x + 1.0) / 2.0, (instance.y + 1.0) / 2.0, 0.5);
+}
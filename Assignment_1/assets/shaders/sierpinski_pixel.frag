@@ -0,0 +1,37 @@
+#version 330 core
+// Decides for every pixel on its own whether it is in the Sierpinski triangle of the given depth.
+// In skewed barycentric coordinates of the root triangle, p = p1 + u (p2 - p1) + v (p3 - p1), the
+// depth d triangles sit on a grid of 2^d x 2^d cells. Each cell is split along its diagonal, and the
+// lower left half (an "up" triangle) of cell (i, j) is a leaf exactly when i & j == 0, the
+// binary form of Pascal's triangle mod 2. The upper right halves are always holes.
+// The cost per pixel is the same at any depth, and the view can pan and zoom
+
+in vec2 ndc;
+out vec4 color;
+
+uniform int depth;
+uniform vec2 centre; // of the view, in the fractal's coordinates
+uniform float zoom;
+
+void main() {
+	vec2 p = centre + ndc / zoom;
+	float v = p.y + 0.5;
+	float u = p.x + 0.5 - 0.5 * v;
+	if (u < 0.0 || v < 0.0 || u + v > 1.0) {
+		discard; // outside the root triangle
+	}
+
+	float cells = exp2(float(depth));
+	vec2 scaled = vec2(u, v) * cells;
+	vec2 cellStart = floor(scaled);
+	vec2 inCell = scaled - cellStart;
+	uvec2 cell = uvec2(cellStart);
+	if (inCell.x + inCell.y >= 1.0 || (cell.x & cell.y) != 0u) {
+		discard;
+	}
+
+	// coloured by the leaf's first corner, as in Fractals.cpp
+	vec2 corner = cellStart / cells;
+	vec2 p1 = vec2(-0.5, -0.5) + corner.x * vec2(1.0, 0.0) + corner.y * vec2(0.5, 1.0);
+	color = vec4((p1.x + 1.0) / 2.0, (p1.y + 1.0) / 2.0, 0.5, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+// For the root triangle of the Sierpinski holes (generateSierpinskiHoles): every pixel gets the colour
+// of the depth d leaf it falls in, worked out from its position like sierpinski_pixel.frag does.
+// Pixels in a hole get some colour too, the holes are drawn over them afterwards
+out vec4 color;
+
+in vec3 fragColor; // the root's own colour, not used
+
+uniform int depth;
+uniform vec4 viewport; // x, y, width, height, to get back from window coordinates to NDC
+
+void main() {
+	vec2 p = (gl_FragCoord.xy - viewport.xy) / viewport.zw * 2.0 - 1.0;
+
+	// skewed barycentric coordinates of the root triangle, p = p1 + u (p2 - p1) + v (p3 - p1),
+	// the leaf's first corner is the corner of its cell on the 2^depth grid
+	float v = p.y + 0.5;
+	float u = p.x + 0.5 - 0.5 * v;
+	float cells = exp2(float(depth));
+	vec2 corner = floor(vec2(u, v) * cells) / cells;
+	vec2 p1 = vec2(-0.5, -0.5) + corner.x * vec2(1.0, 0.0) + corner.y * vec2(0.5, 1.0);
+	color = vec4((p1.x + 1.0) / 2.0, (p1.y + 1.0) / 2.0, 0.5, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec3 pos;
+layout (location = 1) in vec3 color;
+
+// the geometry shader does the work, this only hands the vertices on
+out vec3 vertexPos;
+out vec3 vertexColor;
+
+void main() {
+	gl_Position = vec4(pos, 1.0);
+	vertexPos = pos;
+	vertexColor = color;
+}
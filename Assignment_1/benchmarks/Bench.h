@@ -0,0 +1,194 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// A small benchmark harness for the benchmark tools. A benchmark is a function
+// run in batches: the batch size grows until one batch takes long enough to time
+// reliably (which doubles as the warm-up), then a number of batches are timed,
+// and each gives one sample of the time per iteration. Reported as the median
+// and the 95th percentile, which a few slow samples (another process, a page
+// fault) barely move, unlike the mean. The JSON keeps every sample, so two runs
+// can be compared statistically instead of by a single number.
+//------------------------------------------------------------------------------
+
+#include <fmt/format.h>
+#include <fmt/ranges.h> // fmt::join
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Bench {
+
+	struct Options
+	{
+		int repetitions = 20;	  // timed batches, one sample each
+		double minSampleMs = 2.0; // a batch grows until it takes at least this long
+		std::string filter;		  // only benchmarks whose name contains this
+	};
+
+	struct Result
+	{
+		std::string name;
+		double itemsPerIteration = 0.0; // what one iteration processes (vertices, elements), 0 for none
+		size_t iterations = 0;			// per batch
+		std::vector<double> samples;	// ns per iteration, one per batch, in the order they ran
+		std::vector<std::pair<std::string, double>> metrics; // anything else a tool reports, copied into the JSON
+		// When the samples of several runs of a tool were pooled (fractal-benchgate), the median of each run.
+		// Samples from one process vary less than runs do, so comparisons need the runs too
+		std::vector<double> runMedians;
+
+		double median = 0.0;
+		double p95 = 0.0;
+		double min = 0.0;
+		double mean = 0.0;
+	};
+
+	inline const void *volatile keepSink = nullptr;
+
+	// Makes the compiler assume value is used, so the work producing it isn't optimized away
+	template <typename T>
+	void keep(const T &value)
+	{
+		keepSink = &value;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	// Nearest rank, on sorted samples
+	inline double percentile(const std::vector<double> &sorted, double p)
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+		size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+		return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+	}
+
+	inline void summarize(Result &result)
+	{
+		std::vector<double> sorted = result.samples;
+		std::sort(sorted.begin(), sorted.end());
+		result.median = percentile(sorted, 50.0);
+		result.p95 = percentile(sorted, 95.0);
+		result.min = sorted.empty() ? 0.0 : sorted.front();
+		result.mean = 0.0;
+		for (double sample : sorted)
+		{
+			result.mean += sample / sorted.size();
+		}
+	}
+
+	inline bool selected(const Options &options, const std::string &name)
+	{
+		return options.filter.empty() || name.find(options.filter) != std::string::npos;
+	}
+
+	// Times fn() (one iteration) and appends the result to results, unless the filter skips it
+	template <typename F>
+	void run(std::vector<Result> &results, const Options &options, const std::string &name, double itemsPerIteration, F &&fn)
+	{
+		if (!selected(options, name))
+		{
+			return;
+		}
+		using Clock = std::chrono::steady_clock;
+		auto timeBatch = [&](size_t iterations)
+		{
+			auto start = Clock::now();
+			for (size_t i = 0; i < iterations; i++)
+			{
+				fn();
+			}
+			return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		};
+
+		Result result;
+		result.name = name;
+		result.itemsPerIteration = itemsPerIteration;
+		result.iterations = 1;
+		while (timeBatch(result.iterations) < options.minSampleMs * 1e6 && result.iterations < (size_t(1) << 30))
+		{
+			result.iterations *= 2;
+		}
+		for (int r = 0; r < options.repetitions; r++)
+		{
+			result.samples.push_back(timeBatch(result.iterations) / result.iterations);
+		}
+		summarize(result);
+		results.push_back(std::move(result));
+
+		const Result &last = results.back();
+		std::fprintf(stderr, "%-36s %12.1f ns median %12.1f ns p95\n", name.c_str(), last.median, last.p95);
+	}
+
+	inline std::string toJson(const std::string &suite, const std::vector<Result> &results)
+	{
+		std::string json = fmt::format("{{\n  \"suite\": \"{}\",\n  \"unit\": \"ns\",\n  \"benchmarks\": [", suite);
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const Result &result = results[i];
+			const double itemsPerSec = result.median > 0.0 ? result.itemsPerIteration / (result.median * 1e-9) : 0.0;
+			std::string metrics;
+			for (const auto &metric : result.metrics)
+			{
+				metrics += fmt::format(", \"{}\": {:.3f}", metric.first, metric.second);
+			}
+			if (!result.runMedians.empty())
+			{
+				metrics += fmt::format(", \"run_medians\": [{:.3f}]", fmt::join(result.runMedians, ", "));
+			}
+			json += fmt::format(
+				"{}\n    {{\"name\": \"{}\", \"iterations\": {}, \"median\": {:.3f}, \"p95\": {:.3f}, \"min\": {:.3f}, "
+				"\"mean\": {:.3f}, \"items_per_second\": {:.1f}{},\n     \"samples\": [{:.3f}]}}",
+				i == 0 ? "" : ",", result.name, result.iterations, result.median, result.p95, result.min, result.mean,
+				itemsPerSec, metrics, fmt::join(result.samples, ", "));
+		}
+		json += "\n  ]\n}\n";
+		return json;
+	}
+
+	inline std::string toText(const std::vector<Result> &results)
+	{
+		std::string text = fmt::format("{:<36} {:>14} {:>14} {:>14} {:>10}\n", "benchmark", "median (ns)", "p95 (ns)",
+									   "items/s", "iters");
+		for (const Result &result : results)
+		{
+			const double itemsPerSec = result.median > 0.0 ? result.itemsPerIteration / (result.median * 1e-9) : 0.0;
+			text += fmt::format("{:<36} {:>14.1f} {:>14.1f} {:>14.3g} {:>10}\n", result.name, result.median, result.p95,
+								itemsPerSec, result.iterations);
+		}
+		return text;
+	}
+
+	// CMake adds no optimization flags without a build type, and timings of unoptimized code say little
+	inline void warnIfUnoptimized(const char *tool)
+	{
+#ifndef NDEBUG
+		std::fprintf(stderr, "%s: built without NDEBUG, configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers\n", tool);
+#else
+		(void)tool;
+#endif
+	}
+
+	// path "-" is stdout
+	inline bool write(const std::string &path, const std::string &contents)
+	{
+		std::FILE *file = path == "-" ? stdout : std::fopen(path.c_str(), "w");
+		if (file == nullptr)
+		{
+			return false;
+		}
+		std::fputs(contents.c_str(), file);
+		if (file != stdout)
+		{
+			std::fclose(file);
+		}
+		return true;
+	}
+
+}
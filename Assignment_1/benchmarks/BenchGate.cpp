@@ -0,0 +1,741 @@
+//------------------------------------------------------------------------------
+// fractal-benchgate: catches slowdowns. Runs the generator microbenchmarks and a
+// few render runs of fractal-bench, and compares every result with a baseline
+// recorded earlier on the same machine (baselines/baseline.json in the build directory
+// by default, none is checked in: another machine's timings would say nothing here).
+//
+// Timings are noisy, and noisier between runs than within one: a run keeps its heap
+// layout, clock speed and neighbours on the machine for all of its samples. So the
+// suite is run several times, and a result only counts as a regression when it is
+//   - significant: a one-sided Mann-Whitney U test says the pooled new samples tend
+//     to be larger than the baseline's (p below --alpha). It compares ranks, so a few
+//     outliers on either side don't decide it, and it assumes nothing about the
+//     distribution of the timings
+//   - slower in every run: the fastest new run is slower than the slowest baseline
+//     run, comparing each run's median
+//   - bigger than the noise: the median of the run medians went up by more than
+//     --tolerance percent on top of how much the baseline's runs differ among
+//     themselves. A shift between runs of unchanged code is not a regression
+// Prints a table of every result and exits with 1 if anything regressed.
+//
+//   fractal-benchgate                      run everything, compare with the baseline
+//   fractal-benchgate --record             run everything, make it the new baseline
+//   fractal-benchgate a.json b.json        compare existing results instead of running
+//
+// The baseline is only meaningful on the machine it was recorded on. The render runs
+// use --software, so with Mesa they are at least comparable between build machines.
+//------------------------------------------------------------------------------
+
+#include "Bench.h"
+
+#include <argh.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h> // WEXITSTATUS
+#endif
+
+#ifndef BENCH_BASELINE_DIR
+#define BENCH_BASELINE_DIR "baselines"
+#endif
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+// --- Reading Results ---
+
+// Just enough JSON for what Bench::toJson writes (and anything else well formed)
+struct Json
+{
+	enum Type
+	{
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object,
+	};
+	Type type = Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<Json> items;
+	std::vector<std::pair<std::string, Json>> members;
+
+	const Json *find(const std::string &key) const
+	{
+		for (const auto &member : members)
+		{
+			if (member.first == key)
+			{
+				return &member.second;
+			}
+		}
+		return nullptr;
+	}
+};
+
+class JsonParser
+{
+public:
+	explicit JsonParser(const std::string &text) : text(text) {}
+
+	Json parse()
+	{
+		Json value = parseValue();
+		skipSpace();
+		if (pos != text.size())
+		{
+			fail("trailing characters");
+		}
+		return value;
+	}
+
+private:
+	[[noreturn]] void fail(const char *what) const
+	{
+		throw std::runtime_error(fmt::format("JSON: {} at offset {}", what, pos));
+	}
+
+	void skipSpace()
+	{
+		while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+		{
+			pos++;
+		}
+	}
+
+	bool consume(char c)
+	{
+		skipSpace();
+		if (pos < text.size() && text[pos] == c)
+		{
+			pos++;
+			return true;
+		}
+		return false;
+	}
+
+	void expect(char c)
+	{
+		if (!consume(c))
+		{
+			fail(fmt::format("expected '{}'", c).c_str());
+		}
+	}
+
+	bool literal(const char *word)
+	{
+		const size_t length = std::char_traits<char>::length(word);
+		if (text.compare(pos, length, word) == 0)
+		{
+			pos += length;
+			return true;
+		}
+		return false;
+	}
+
+	std::string parseString()
+	{
+		expect('"');
+		std::string result;
+		while (pos < text.size() && text[pos] != '"')
+		{
+			char c = text[pos++];
+			if (c == '\\' && pos < text.size())
+			{ // the names are plain ASCII, \uXXXX is kept as it is
+				char escaped = text[pos++];
+				switch (escaped)
+				{
+				case 'n':
+					c = '\n';
+					break;
+				case 't':
+					c = '\t';
+					break;
+				case 'u':
+					result += "\\u";
+					continue;
+				default:
+					c = escaped;
+					break;
+				}
+			}
+			result += c;
+		}
+		if (pos >= text.size())
+		{
+			fail("unterminated string");
+		}
+		pos++;
+		return result;
+	}
+
+	Json parseValue()
+	{
+		skipSpace();
+		if (pos >= text.size())
+		{
+			fail("unexpected end");
+		}
+		Json value;
+		const char c = text[pos];
+		if (c == '{')
+		{
+			value.type = Json::Object;
+			pos++;
+			if (!consume('}'))
+			{
+				do
+				{
+					skipSpace();
+					std::string key = parseString();
+					expect(':');
+					value.members.emplace_back(std::move(key), parseValue());
+				} while (consume(','));
+				expect('}');
+			}
+		}
+		else if (c == '[')
+		{
+			value.type = Json::Array;
+			pos++;
+			if (!consume(']'))
+			{
+				do
+				{
+					value.items.push_back(parseValue());
+				} while (consume(','));
+				expect(']');
+			}
+		}
+		else if (c == '"')
+		{
+			value.type = Json::String;
+			value.string = parseString();
+		}
+		else if (literal("true") || literal("false"))
+		{
+			value.type = Json::Bool;
+			value.boolean = text[pos - 1] == 'e' && text[pos - 2] == 'u';
+		}
+		else if (literal("null"))
+		{
+			value.type = Json::Null;
+		}
+		else
+		{
+			value.type = Json::Number;
+			const char *start = text.c_str() + pos;
+			char *end = nullptr;
+			value.number = std::strtod(start, &end);
+			if (end == start)
+			{
+				fail("unexpected character");
+			}
+			pos += end - start;
+		}
+		return value;
+	}
+
+	const std::string &text;
+	size_t pos = 0;
+};
+
+std::vector<Bench::Result> readResults(const fs::path &path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		throw std::runtime_error(fmt::format("can't read {}", path.string()));
+	}
+	std::stringstream contents;
+	contents << file.rdbuf();
+	const Json root = JsonParser(contents.str()).parse();
+
+	const Json *benchmarks = root.find("benchmarks");
+	if (benchmarks == nullptr || benchmarks->type != Json::Array)
+	{
+		throw std::runtime_error(fmt::format("{} has no \"benchmarks\" array", path.string()));
+	}
+	std::vector<Bench::Result> results;
+	for (const Json &benchmark : benchmarks->items)
+	{
+		const Json *name = benchmark.find("name");
+		const Json *samples = benchmark.find("samples");
+		if (name == nullptr || samples == nullptr || samples->type != Json::Array)
+		{
+			throw std::runtime_error(fmt::format("{}: a benchmark without a name or samples", path.string()));
+		}
+		Bench::Result result;
+		result.name = name->string;
+		if (const Json *iterations = benchmark.find("iterations"))
+		{
+			result.iterations = static_cast<size_t>(iterations->number);
+		}
+		if (const Json *items = benchmark.find("items_per_second"))
+		{ // back to items per iteration, so writing a baseline gives the same numbers again
+			const Json *median = benchmark.find("median");
+			result.itemsPerIteration = median != nullptr ? items->number * median->number * 1e-9 : 0.0;
+		}
+		for (const Json &sample : samples->items)
+		{
+			result.samples.push_back(sample.number);
+		}
+		if (const Json *runMedians = benchmark.find("run_medians"))
+		{
+			for (const Json &median : runMedians->items)
+			{
+				result.runMedians.push_back(median.number);
+			}
+		}
+		Bench::summarize(result);
+		results.push_back(std::move(result));
+	}
+	return results;
+}
+
+// --- Comparing ---
+
+// One-sided Mann-Whitney U test: the probability of samples at least this much larger than the
+// baseline's if both came from the same distribution. Normal approximation with the tie correction,
+// which is good from about 8 samples a side (the tools take 20)
+double mannWhitneyGreater(const std::vector<double> &current, const std::vector<double> &baseline)
+{
+	const size_t n1 = current.size();
+	const size_t n2 = baseline.size();
+	if (n1 == 0 || n2 == 0)
+	{
+		return 1.0;
+	}
+	std::vector<std::pair<double, int>> all; // value, 0 current, 1 baseline
+	for (double value : current)
+	{
+		all.emplace_back(value, 0);
+	}
+	for (double value : baseline)
+	{
+		all.emplace_back(value, 1);
+	}
+	std::sort(all.begin(), all.end());
+
+	// ranks from 1, ties get the average of the ranks they span
+	const double n = static_cast<double>(all.size());
+	double rankSum = 0.0; // of the current samples
+	double tieTerm = 0.0; // sum of t^3 - t over the groups of ties
+	for (size_t i = 0; i < all.size();)
+	{
+		size_t j = i;
+		while (j < all.size() && all[j].first == all[i].first)
+		{
+			j++;
+		}
+		const double averageRank = (i + 1 + j) / 2.0;
+		for (size_t k = i; k < j; k++)
+		{
+			if (all[k].second == 0)
+			{
+				rankSum += averageRank;
+			}
+		}
+		const double t = static_cast<double>(j - i);
+		tieTerm += t * t * t - t;
+		i = j;
+	}
+
+	const double u = rankSum - n1 * (n1 + 1) / 2.0;
+	const double mean = n1 * n2 / 2.0;
+	const double variance = n1 * n2 / 12.0 * ((n + 1.0) - tieTerm / (n * (n - 1.0)));
+	if (variance <= 0.0)
+	{ // every sample the same
+		return u > mean ? 0.0 : 1.0;
+	}
+	const double z = (u - mean - 0.5) / std::sqrt(variance); // with continuity correction
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+// The median of every run, a result that wasn't pooled is one run
+std::vector<double> runMedians(const Bench::Result &result)
+{
+	return result.runMedians.empty() ? std::vector<double>{result.median} : result.runMedians;
+}
+
+double medianOf(std::vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+	const size_t n = values.size();
+	return n == 0 ? 0.0 : n % 2 == 1 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+struct Options
+{
+	fs::path baseline = fs::path(BENCH_BASELINE_DIR) / "baseline.json";
+	fs::path binDir;  // where the other tools are, next to this one by default
+	fs::path workDir; // for their output
+	double alpha = 0.01;
+	double tolerance = 5.0; // percent
+	int runs = 3;			// of the whole suite, pooled
+	double pause = 0.0;		// seconds between runs
+	bool record = false;
+	bool strict = false; // a benchmark missing from the new results fails too
+	bool skipRender = false;
+	bool requireGl = false;
+	std::vector<fs::path> inputs; // existing results, instead of running the tools
+};
+
+enum class Verdict
+{
+	Same,
+	Faster,
+	Slower, // significant, but within tolerance
+	Regression,
+	New,
+	Missing,
+};
+
+const char *verdictName(Verdict verdict)
+{
+	switch (verdict)
+	{
+	case Verdict::Same:
+		return "ok";
+	case Verdict::Faster:
+		return "faster";
+	case Verdict::Slower:
+		return "slower (within tolerance)";
+	case Verdict::Regression:
+		return "REGRESSION";
+	case Verdict::New:
+		return "new";
+	case Verdict::Missing:
+		return "MISSING";
+	}
+	return "";
+}
+
+// Returns the number of failures
+int compare(const std::vector<Bench::Result> &baseline, const std::vector<Bench::Result> &current, const Options &options)
+{
+	std::map<std::string, const Bench::Result *> baselineByName;
+	for (const Bench::Result &result : baseline)
+	{
+		baselineByName[result.name] = &result;
+	}
+
+	// the medians are of the run medians, noise is how far apart the baseline's runs are
+	std::string table = fmt::format("{:<40} {:>14} {:>14} {:>9} {:>8} {:>9}  {}\n", "benchmark", "baseline (ns)",
+									"current (ns)", "change", "noise", "p", "verdict");
+	int failures = 0;
+	auto row = [&](const std::string &name, double before, double after, double change, double noise, double p,
+				   Verdict verdict)
+	{
+		table += fmt::format("{:<40} {:>14.1f} {:>14.1f} {:>+8.1f}% {:>7.1f}% {:>9.2g}  {}\n", name, before, after, change,
+							 noise, p, verdictName(verdict));
+		if (verdict == Verdict::Regression || (verdict == Verdict::Missing && options.strict))
+		{
+			failures++;
+		}
+	};
+
+	for (const Bench::Result &result : current)
+	{
+		auto found = baselineByName.find(result.name);
+		if (found == baselineByName.end())
+		{
+			row(result.name, 0.0, medianOf(runMedians(result)), 0.0, 0.0, 1.0, Verdict::New);
+			continue;
+		}
+		const Bench::Result &before = *found->second;
+		baselineByName.erase(found);
+
+		const std::vector<double> beforeRuns = runMedians(before);
+		const std::vector<double> afterRuns = runMedians(result);
+		const double beforeMedian = medianOf(beforeRuns);
+		const double afterMedian = medianOf(afterRuns);
+		const double change = beforeMedian > 0.0 ? (afterMedian / beforeMedian - 1.0) * 100.0 : 0.0;
+		const auto [fastestBefore, slowestBefore] = std::minmax_element(beforeRuns.begin(), beforeRuns.end());
+		const auto [fastestAfter, slowestAfter] = std::minmax_element(afterRuns.begin(), afterRuns.end());
+		const double noise = *fastestBefore > 0.0 ? (*slowestBefore / *fastestBefore - 1.0) * 100.0 : 0.0;
+		// three runs rarely show the whole spread, so the tolerance comes on top of it
+		const double allowed = options.tolerance + noise;
+
+		const double pSlower = mannWhitneyGreater(result.samples, before.samples);
+		const double pFaster = mannWhitneyGreater(before.samples, result.samples);
+		Verdict verdict = Verdict::Same;
+		double p = std::min(pSlower, pFaster);
+		if (pSlower < options.alpha && *fastestAfter > *slowestBefore)
+		{
+			verdict = change > allowed ? Verdict::Regression : Verdict::Slower;
+		}
+		else if (pFaster < options.alpha && *slowestAfter < *fastestBefore && change < -allowed)
+		{
+			verdict = Verdict::Faster;
+		}
+		row(result.name, beforeMedian, afterMedian, change, noise, p, verdict);
+	}
+	for (const auto &missing : baselineByName)
+	{
+		row(missing.first, medianOf(runMedians(*missing.second)), 0.0, 0.0, 0.0, 1.0, Verdict::Missing);
+	}
+
+	std::fputs(table.c_str(), stdout);
+	const bool singleRun = std::all_of(baseline.begin(), baseline.end(),
+									   [](const Bench::Result &result) { return runMedians(result).size() < 2; });
+	if (!baseline.empty() && singleRun)
+	{
+		std::fprintf(stderr, "fractal-benchgate: the baseline is a single run, so the noise between runs is unknown. "
+							 "Record it with --runs 3 or more\n");
+	}
+	return failures;
+}
+
+// --- Running The Tools ---
+
+fs::path toolPath(const Options &options, const char *tool)
+{
+#if defined(_WIN32)
+	return options.binDir / (std::string(tool) + ".exe");
+#else
+	return options.binDir / tool;
+#endif
+}
+
+// The tool's own output goes to <work dir>/<tool>.log, the table is the only thing worth reading here
+int runTool(const Options &options, const char *tool, const std::string &arguments)
+{
+	const fs::path log = options.workDir / fmt::format("{}.log", tool);
+	const std::string command =
+		fmt::format("\"{}\" {} >> \"{}\"", toolPath(options, tool).string(), arguments, log.string());
+	std::fprintf(stderr, "fractal-benchgate: %s\n", command.c_str());
+	const int status = std::system(command.c_str());
+#if defined(_WIN32)
+	return status;
+#else
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+// Adds the samples of each result to the one with the same name, or appends it. Either way its run
+// medians are kept, one per run (or as many as it already had, when it was pooled itself)
+void pool(std::vector<Bench::Result> &results, std::vector<Bench::Result> &&more)
+{
+	for (Bench::Result &result : more)
+	{
+		const std::vector<double> medians = runMedians(result);
+		auto same = std::find_if(results.begin(), results.end(),
+								 [&](const Bench::Result &existing) { return existing.name == result.name; });
+		if (same == results.end())
+		{
+			result.runMedians = medians;
+			results.push_back(std::move(result));
+			continue;
+		}
+		same->samples.insert(same->samples.end(), result.samples.begin(), result.samples.end());
+		same->runMedians.insert(same->runMedians.end(), medians.begin(), medians.end());
+		Bench::summarize(*same);
+	}
+}
+
+// One run of the generator benchmarks and every fractal drawn offscreen. Throws if a tool fails
+void runSuiteOnce(const Options &options, std::vector<Bench::Result> &results, bool &renderSkipped)
+{
+	const fs::path micro = options.workDir / "micro.json";
+	if (runTool(options, "fractal-microbench", fmt::format("--filter generate/ --json \"{}\"", micro.string())) != 0)
+	{
+		throw std::runtime_error("fractal-microbench failed");
+	}
+	pool(results, readResults(micro));
+
+	if (options.skipRender || renderSkipped)
+	{
+		return;
+	}
+	struct Run
+	{
+		const char *fractal;
+		int depth;
+	};
+	for (const Run &run : {Run{"sierpinski", 8}, Run{"levy", 14}, Run{"tree", 8}})
+	{
+		const fs::path samples = options.workDir / fmt::format("render-{}.json", run.fractal);
+		const fs::path report = options.workDir / fmt::format("render-{}.txt", run.fractal);
+		const int status = runTool(options, "fractal-bench",
+								   fmt::format("-f {} -d {} --render --software --repeat 20 --frames 30 --size 512 "
+											   "--out \"{}\" --samples \"{}\"",
+											   run.fractal, run.depth, report.string(), samples.string()));
+		if (status == 2 && !options.requireGl)
+		{ // no OpenGL here: the render results will be missing, which only fails with --strict
+			std::fprintf(stderr, "fractal-benchgate: no OpenGL context, skipping the render benchmarks\n");
+			renderSkipped = true;
+			return;
+		}
+		if (status != 0)
+		{
+			throw std::runtime_error(fmt::format("fractal-bench failed for {}", run.fractal));
+		}
+		pool(results, readResults(samples));
+	}
+}
+
+// Samples from one process are more alike than samples from separate runs (same heap layout, same
+// clock speed, same neighbours on the machine). The runs are pooled, and each one's median is kept,
+// so compare can tell how much the runs themselves differ
+std::vector<Bench::Result> runSuite(const Options &options)
+{
+	fs::create_directories(options.workDir);
+	for (const char *tool : {"fractal-microbench", "fractal-bench"})
+	{ // the logs are appended to, one per gate run is enough
+		fs::remove(options.workDir / fmt::format("{}.log", tool));
+	}
+	std::vector<Bench::Result> results;
+	bool renderSkipped = false;
+	for (int run = 0; run < options.runs; run++)
+	{
+		if (run > 0 && options.pause > 0.0)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(options.pause));
+		}
+		runSuiteOnce(options, results, renderSkipped);
+	}
+	return results;
+}
+
+const char *usage = R"(fractal-benchgate: runs the benchmarks and fails on slowdowns against a baseline
+
+  fractal-benchgate [options] [results.json ...]
+
+  --baseline <path>    the baseline to compare with or record (default baselines/baseline.json in
+                       the build directory). Comparing fails until there is one, record it first
+  --record             make the new results the baseline instead of comparing
+  --alpha <p>          significance level of the Mann-Whitney test (default 0.01)
+  --tolerance <pct>    how much slower the median may get before it fails (default 5), on top
+                       of how much the baseline's runs differ (the noise column)
+  --strict             also fail when a baseline benchmark is missing from the results
+  --runs <n>           how many times to run the suite, the samples are pooled (default 3)
+                       and each run's median is kept. Use at least 3 for the baseline
+  --pause <s>          seconds to wait between runs. A baseline recorded over a few minutes
+                       also sees how much the machine drifts (clock speed, other load)
+  --skip-render        only the generator benchmarks
+  --require-gl         fail instead of skipping the render benchmarks without OpenGL
+  --bin-dir <path>     where fractal-microbench and fractal-bench are (default next to this)
+  --work-dir <path>    where their output goes (default a temporary directory)
+
+Results files given on the command line are compared (or recorded) instead of running anything,
+each as one run (pooled like --runs when a benchmark is in several).
+Exits with 0 when nothing regressed, 1 when something did, 2 on errors.
+)";
+
+}
+
+int main(int argc, char **argv)
+{
+	argh::parser cmdl({"--baseline", "--alpha", "--tolerance", "--runs", "--pause", "--bin-dir", "--work-dir"});
+	cmdl.parse(argc, argv);
+	if (cmdl[{"-h", "--help"}])
+	{
+		std::fputs(usage, stdout);
+		return 0;
+	}
+
+	Options options;
+	std::string path;
+	if (cmdl("--baseline") >> path)
+	{
+		options.baseline = path;
+	}
+	options.binDir = fs::absolute(argv[0]).parent_path();
+	if (cmdl("--bin-dir") >> path)
+	{
+		options.binDir = path;
+	}
+	options.workDir = fs::temp_directory_path() / "fractal-benchgate";
+	if (cmdl("--work-dir") >> path)
+	{
+		options.workDir = path;
+	}
+	if (!(cmdl("--alpha", options.alpha) >> options.alpha) || options.alpha <= 0.0 || options.alpha >= 1.0 ||
+		!(cmdl("--tolerance", options.tolerance) >> options.tolerance) || options.tolerance < 0.0 ||
+		!(cmdl("--runs", options.runs) >> options.runs) || options.runs < 1 ||
+		!(cmdl("--pause", options.pause) >> options.pause) || options.pause < 0.0)
+	{
+		std::fprintf(stderr,
+					 "fractal-benchgate: --alpha takes (0, 1), --tolerance a percentage, --runs at least 1, "
+					 "--pause seconds\n\n%s",
+					 usage);
+		return 2;
+	}
+	options.record = cmdl["--record"];
+	options.strict = cmdl["--strict"];
+	options.skipRender = cmdl["--skip-render"];
+	options.requireGl = cmdl["--require-gl"];
+	for (size_t i = 1; i < cmdl.size(); i++)
+	{
+		options.inputs.push_back(cmdl[i]);
+	}
+
+	std::vector<Bench::Result> current;
+	try
+	{
+		if (!options.record && !fs::exists(options.baseline))
+		{ // before running anything, the suite takes minutes
+			throw std::runtime_error(fmt::format(
+				"no baseline at {}. Baselines only compare on the machine they were recorded on, record one "
+				"first with --record (on a quiet machine, e.g. --record --runs 5) or pass --baseline <path>",
+				options.baseline.string()));
+		}
+		if (options.inputs.empty())
+		{
+			current = runSuite(options);
+		}
+		for (const fs::path &input : options.inputs)
+		{
+			pool(current, readResults(input));
+		}
+
+		if (options.record)
+		{
+			if (options.baseline.has_parent_path())
+			{
+				fs::create_directories(options.baseline.parent_path());
+			}
+			if (!Bench::write(options.baseline.string(), Bench::toJson("fractal-benchgate", current)))
+			{
+				throw std::runtime_error(fmt::format("can't write {}", options.baseline.string()));
+			}
+			std::printf("fractal-benchgate: recorded %zu benchmarks as %s\n", current.size(), options.baseline.string().c_str());
+			return 0;
+		}
+
+		const std::vector<Bench::Result> baseline = readResults(options.baseline);
+		const int failures = compare(baseline, current, options);
+		if (failures > 0)
+		{
+			std::printf("fractal-benchgate: %d regression(s) beyond %.1f%% (p < %g)\n", failures, options.tolerance, options.alpha);
+			return 1;
+		}
+		std::printf("fractal-benchgate: no regressions against %s\n", options.baseline.string().c_str());
+		return 0;
+	}
+	catch (const std::exception &e)
+	{
+		std::fprintf(stderr, "fractal-benchgate: %s\n", e.what());
+		return 2;
+	}
+}
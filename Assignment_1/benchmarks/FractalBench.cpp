@@ -0,0 +1,853 @@
+//------------------------------------------------------------------------------
+// fractal-bench: generates one fractal at a given depth, over and over, without
+// the interactive window, and reports how fast. Optionally it also uploads the
+// result and draws it into an offscreen framebuffer. Meant to be run from scripts,
+// so it needs no display (see HeadlessContext.h) and can print JSON.
+//
+//   fractal-bench --fractal levy --depth 16 --threads 4 --json
+//   fractal-bench -f sierpinski -d 10 --colors shader --render --frames 50 -o result.json
+//   fractal-bench -f tree -d 8 --source procedural --software
+//   fractal-bench -f levy -d 12 --source compute --software
+//   fractal-bench -f sierpinski -d 8 --source subdivide --gpu-levels 3 --software
+//
+// Run with --help for every option.
+//------------------------------------------------------------------------------
+
+#include "Bench.h"
+
+#include "AssetPath.h"
+#include "ComputeFractals.h"
+#include "Fractals.h"
+#include "Framebuffer.h"
+#include "Geometry.h"
+#include "GLState.h"
+#include "GpuSubdivision.h"
+#include "HeadlessContext.h"
+#include "MemoryStats.h"
+#include "ShaderProgram.h"
+#include "VertexArray.h"
+
+#include <argh.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+enum class Fractal
+{
+	Sierpinski,
+	Levy,
+	Tree,
+};
+
+// Where the drawn vertices come from, the main window's geometry sources that need no CPU work
+enum class Source
+{
+	Vertices,	// generated on the CPU and uploaded
+	Procedural, // worked out by procedural.vert from gl_VertexID
+	Compute,	// generated by fractal.comp, where the build and context can (otherwise uploaded, like the window)
+	Subdivide,	// the last gpuLevels levels added by geometry shader passes with transform feedback (not the tree)
+};
+
+struct Options
+{
+	Fractal fractal = Fractal::Sierpinski;
+	std::string fractalName = "sierpinski";
+	int depth = 8;
+	int threads = 1;		// independent generations running at the same time
+	int repeat = 10;		// timed generations per thread (after one untimed warm-up)
+	bool shaderColors = false; // the compact vertex format of "Colours In Shader" instead of a vec3 per vertex
+	bool ancestors = false; // also write where every vertex was one depth up (the depth morph's format)
+	bool upload = false;
+	bool mapped = false; // generate straight into mapped buffers instead of uploading a CPU copy
+	bool render = false; // implies upload
+	Source source = Source::Vertices; // anything else implies render, and is compared with the uploaded vertices
+	std::string sourceName = "vertices";
+	int gpuLevels = 2; // with --source subdivide, at most depth
+	int frames = 20;
+	int size = 1024; // of the offscreen target, in pixels
+	bool software = false; // Mesa's llvmpipe even where there is a GPU
+	bool json = false;
+	std::string out; // empty for stdout
+	std::string samples; // every timing in the Bench.h format, empty for none
+};
+
+const char *usage = R"(fractal-bench: time fractal generation, upload and rendering without a window
+
+  -f, --fractal <name>  sierpinski, levy or tree (default sierpinski)
+  -d, --depth <n>       recursion depth (default 8), at most 18 for sierpinski and tree, 29 for
+                        levy (where the vertex count still fits in a GLsizei)
+  -t, --threads <n>     generations running in parallel, 0 for one per core (default 1)
+  -r, --repeat <n>      timed generations per thread (default 10)
+  --colors <format>     vertex colours: vec3 (12 bytes per vertex) or shader (the compact
+                        "Colours In Shader" format: none for sierpinski, 2 bytes otherwise)
+  --ancestors           also write the depth morph's second position
+  --upload [how]         upload the geometry to a VBO (needs OpenGL, see below): copy (the
+                        default, generated into a CPU_Geometry then glBufferData) or mapped
+                        (generated straight into glMapBufferRange memory, no CPU copy kept)
+  --render              upload it and draw it into an offscreen framebuffer
+  --frames <n>          frames to draw with --render (default 20)
+  --size <n>            width and height of the offscreen framebuffer (default 1024)
+  --source <name>       what the frames draw: vertices (uploaded, the default), procedural
+                        (procedural.vert, no vertex buffers) or compute (fractal.comp, needs a
+                        -DFRACTAL_GL46=ON build and a GL 4.3 context, otherwise it falls back
+                        to the uploaded vertices like the window does) or subdivide (the CPU
+                        generates --gpu-levels fewer levels and geometry shader passes add them,
+                        sierpinski and levy only). Implies --render.
+                        Anything but vertices is also drawn from the uploaded vertices, and when
+                        a single pixel differs the report says so and the exit code is 3
+  --gpu-levels <n>      levels --source subdivide leaves to the GPU (default 2)
+  --software            use Mesa's software rasterizer (llvmpipe) even where there is a GPU
+  --json                print JSON instead of text
+  -o, --out <path>      write the report to a file instead of stdout
+  --samples <path>      also write every timing in the format of the other benchmark tools
+                        (what fractal-benchgate compares)
+
+--upload and --render create a hidden window, or without a display an EGL (Mesa surfaceless)
+or OSMesa context. Shader loading logs to stdout, so use --out for clean JSON.
+Exit codes: 1 bad options or output file, 2 no context, 3 --source drew different pixels,
+4 out of memory.
+)";
+
+size_t vertexCount(Fractal fractal, int depth)
+{
+	switch (fractal)
+	{
+	case Fractal::Sierpinski:
+		return sierpinskiVertexCount(depth);
+	case Fractal::Levy:
+		return levyVertexCount(depth);
+	case Fractal::Tree:
+		return treeVertexCount(depth);
+	}
+	return 0;
+}
+
+// The deepest depth whose vertex count still fits in the GLsizei glDrawArrays takes. One generation
+// at that depth is tens of GB, more than fits in memory anyway (which fails with exit code 4)
+int maxDepth(Fractal fractal)
+{
+	int depth = 0;
+	while (vertexCount(fractal, depth + 1) <= static_cast<size_t>(std::numeric_limits<GLsizei>::max()))
+	{
+		depth++;
+	}
+	return depth;
+}
+
+int parsePositive(const argh::parser &cmdl, std::initializer_list<const char *const> names, int fallback, int minimum)
+{
+	int value = fallback;
+	if (!(cmdl(names, fallback) >> value) || value < minimum)
+	{
+		throw std::invalid_argument(fmt::format("{} needs a whole number of at least {}", *names.begin(), minimum));
+	}
+	return value;
+}
+
+Options parseOptions(int argc, char **argv)
+{
+	// options that take a value have to be registered, otherwise "--depth 8" reads as a flag and a stray 8
+	argh::parser cmdl({"-f", "--fractal", "-d", "--depth", "-t", "--threads", "-r", "--repeat", "--colors",
+					   "--frames", "--size", "--source", "--gpu-levels", "--upload", "-o", "--out", "--samples"});
+	cmdl.parse(argc, argv);
+
+	Options options;
+	cmdl({"-f", "--fractal"}, "sierpinski") >> options.fractalName;
+	if (options.fractalName == "sierpinski")
+	{
+		options.fractal = Fractal::Sierpinski;
+	}
+	else if (options.fractalName == "levy")
+	{
+		options.fractal = Fractal::Levy;
+	}
+	else if (options.fractalName == "tree")
+	{
+		options.fractal = Fractal::Tree;
+	}
+	else
+	{
+		throw std::invalid_argument(fmt::format("unknown fractal '{}'", options.fractalName));
+	}
+
+	options.depth = parsePositive(cmdl, {"-d", "--depth"}, options.depth, 0);
+	if (options.depth > maxDepth(options.fractal))
+	{
+		throw std::invalid_argument(fmt::format("--depth {} is too deep for {}, the most is {}", options.depth,
+												options.fractalName, maxDepth(options.fractal)));
+	}
+	options.threads = parsePositive(cmdl, {"-t", "--threads"}, options.threads, 0);
+	if (options.threads == 0)
+	{
+		options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+	}
+	options.repeat = parsePositive(cmdl, {"-r", "--repeat"}, options.repeat, 1);
+	options.frames = parsePositive(cmdl, {"--frames"}, options.frames, 1);
+	options.size = parsePositive(cmdl, {"--size"}, options.size, 1);
+
+	std::string colors;
+	cmdl({"--colors"}, "vec3") >> colors;
+	if (colors != "vec3" && colors != "shader")
+	{
+		throw std::invalid_argument(fmt::format("unknown colour format '{}'", colors));
+	}
+	options.shaderColors = colors == "shader";
+
+	cmdl({"--source"}, "vertices") >> options.sourceName;
+	if (options.sourceName == "vertices")
+	{
+		options.source = Source::Vertices;
+	}
+	else if (options.sourceName == "procedural")
+	{
+		options.source = Source::Procedural;
+	}
+	else if (options.sourceName == "compute")
+	{
+		options.source = Source::Compute;
+	}
+	else if (options.sourceName == "subdivide")
+	{
+		options.source = Source::Subdivide;
+	}
+	else
+	{
+		throw std::invalid_argument(fmt::format("unknown source '{}'", options.sourceName));
+	}
+	if (options.source == Source::Subdivide && options.fractal == Fractal::Tree)
+	{ // the window uploads the tree as usual in this mode, its older branches stay as they are
+		throw std::invalid_argument("--source subdivide is for sierpinski and levy, the tree isn't a pure subdivision");
+	}
+	options.gpuLevels = std::min(parsePositive(cmdl, {"--gpu-levels"}, options.gpuLevels, 1), options.depth);
+	if (options.source != Source::Vertices && options.shaderColors)
+	{ // the other sources write vec3 colours, the derived ones wouldn't match them
+		throw std::invalid_argument("--source is compared with vec3 colours, it can't be used with --colors shader");
+	}
+
+	options.ancestors = cmdl["--ancestors"];
+	options.render = cmdl["--render"] || options.source != Source::Vertices;
+	// a bare --upload is a flag (argh only takes the next argument as its value when it isn't an option)
+	std::string upload = "copy";
+	cmdl({"--upload"}, upload) >> upload;
+	if (upload != "copy" && upload != "mapped")
+	{
+		throw std::invalid_argument(fmt::format("unknown upload '{}'", upload));
+	}
+	options.mapped = upload == "mapped";
+	options.upload = cmdl["--upload"] || cmdl({"--upload"}) || options.render;
+	options.software = cmdl["--software"];
+	options.json = cmdl["--json"];
+	cmdl({"-o", "--out"}) >> options.out;
+	cmdl({"--samples"}) >> options.samples;
+	return options;
+}
+
+// The FractalTypes order, what the shaders' fractal uniform takes
+int fractalIndex(Fractal fractal)
+{
+	return fractal == Fractal::Sierpinski ? 0 : fractal == Fractal::Levy ? 1 : 2;
+}
+
+VertexColors vertexColors(const Options &options)
+{ // the same choice as the main window's
+	if (!options.shaderColors)
+	{
+		return VertexColors::PerVertex;
+	}
+	return options.fractal == Fractal::Sierpinski ? VertexColors::Derived : VertexColors::Shades;
+}
+
+size_t bytesPerVertex(const Options &options)
+{
+	size_t bytes = sizeof(glm::vec3) * (options.ancestors ? 2 : 1);
+	switch (vertexColors(options))
+	{
+	case VertexColors::PerVertex:
+		return bytes + sizeof(glm::vec3);
+	case VertexColors::Shades:
+		return bytes + sizeof(std::uint16_t);
+	case VertexColors::Derived:
+		break;
+	}
+	return bytes;
+}
+
+void generate(const Options &options, const GeometryOutput &out)
+{
+	switch (options.fractal)
+	{
+	case Fractal::Sierpinski:
+		generateSierpinskiTriangle(out, options.depth);
+		break;
+	case Fractal::Levy:
+		generateLevyCurve(out, options.depth);
+		break;
+	case Fractal::Tree:
+		generateTree(out, options.depth);
+		break;
+	}
+}
+
+// Sizes the arrays the way the main window's "Upload From CPU" path does, and generates into them
+void generate(const Options &options, CPU_Geometry &geom)
+{
+	const size_t count = vertexCount(options.fractal, options.depth);
+	const VertexColors colors = vertexColors(options);
+	geom.verts.resize(count);
+	geom.cols.resize(colors == VertexColors::PerVertex ? count : 0);
+	geom.ancestors.resize(options.ancestors ? count : 0);
+	geom.shades.resize(colors == VertexColors::Shades ? count : 0);
+
+	GeometryOutput out;
+	out.verts = geom.verts.data();
+	out.cols = geom.cols.empty() ? nullptr : geom.cols.data();
+	out.ancestors = geom.ancestors.empty() ? nullptr : geom.ancestors.data();
+	out.shades = geom.shades.empty() ? nullptr : geom.shades.data();
+	generate(options, out);
+}
+
+double msSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Timings
+{
+	double min = 0.0;
+	double median = 0.0;
+	double max = 0.0;
+};
+
+Timings summarize(std::vector<double> times)
+{
+	Timings timings;
+	if (times.empty())
+	{
+		return timings;
+	}
+	std::sort(times.begin(), times.end());
+	timings.min = times.front();
+	timings.median = times[times.size() / 2];
+	timings.max = times.back();
+	return timings;
+}
+
+struct Report
+{
+	size_t vertices = 0; // of one generation
+	size_t bytes = 0;	 // of one generation
+	Timings generateMs;	 // of one generation, over every thread
+	double generateWallMs = 0.0; // the whole timed phase, every thread
+	double verticesPerSec = 0.0; // over every thread
+
+	std::string renderer; // empty without OpenGL
+	Timings uploadMs; // with --upload mapped: mapping, generating into the mapping and unmapping
+	size_t gpuPeakRss = 0; // while uploading and drawing, the generation phase's copies gone but the one uploaded
+	Timings frameMs;
+
+	// --source other than vertices: pixels of the last frame that aren't what the uploaded vertices draw
+	size_t comparedPixels = 0;
+	size_t differingPixels = 0;
+	std::string computeFallback; // why --source compute drew the uploaded vertices, empty when it didn't
+
+	// --source subdivide: the coarse fractal the CPU generates, and the GPU passes that finish it
+	size_t coarseBytes = 0;
+	Timings coarseGenerateMs;
+	Timings subdivideMs; // uploading the coarse fractal and every pass, until the GPU is done
+	std::vector<double> subdivideSamples;
+
+	// every timing, in ms, for --samples
+	std::vector<double> generateSamples;
+	std::vector<double> uploadSamples;
+	std::vector<double> frameSamples;
+
+	double wallMs = 0.0;
+	size_t peakRss = 0;
+};
+
+// The generators are sequential, so threads doesn't split one fractal: every thread generates
+// its own copy, and the total shows how generation scales with cores (memory bandwidth, mostly).
+// Thread 0's geometry is kept for the upload
+void benchmarkGeneration(const Options &options, Report &report, CPU_Geometry &kept)
+{
+	report.vertices = vertexCount(options.fractal, options.depth);
+	report.bytes = report.vertices * bytesPerVertex(options);
+
+	std::vector<std::vector<double>> times(options.threads);
+	std::vector<CPU_Geometry> geometries(options.threads);
+	for (CPU_Geometry &geom : geometries)
+	{ // warm-up, so the timed runs don't pay for page faults on fresh memory
+		generate(options, geom);
+	}
+
+	auto wallStart = std::chrono::steady_clock::now();
+	auto work = [&](int thread)
+	{
+		for (int i = 0; i < options.repeat; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			generate(options, geometries[thread]);
+			times[thread].push_back(msSince(start));
+		}
+	};
+	std::vector<std::thread> workers;
+	for (int thread = 1; thread < options.threads; thread++)
+	{
+		workers.emplace_back(work, thread);
+	}
+	work(0);
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+	report.generateWallMs = msSince(wallStart);
+
+	std::vector<double> all;
+	for (const std::vector<double> &threadTimes : times)
+	{
+		all.insert(all.end(), threadTimes.begin(), threadTimes.end());
+	}
+	report.generateMs = summarize(all);
+	report.generateSamples = all;
+	const double generated = static_cast<double>(report.vertices) * options.threads * options.repeat;
+	report.verticesPerSec = report.generateWallMs > 0.0 ? generated / (report.generateWallMs / 1000.0) : 0.0;
+
+	std::swap(kept, geometries[0]);
+}
+
+std::vector<std::uint8_t> readPixels(int size)
+{
+	std::vector<std::uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+	glReadPixels(0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	return pixels;
+}
+
+// Every upload and frame ends with glFinish, so the times are the GPU's and not just the driver queueing the work.
+// With --upload mapped, geom is empty and every upload generates into the mapped buffers (the window's
+// "Generate Into GPU Memory")
+void benchmarkGpu(const Options &options, Report &report, const CPU_Geometry &geom)
+{
+	report.renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+	report.peakRss = MemoryStats::peakRss(); // of the generation phase, the reset below would lose it
+	MemoryStats::resetPeak();
+
+	GPU_Geometry gGeom;
+	const size_t vertices = vertexCount(options.fractal, options.depth);
+	auto upload = [&]()
+	{
+		if (options.mapped)
+		{
+			generate(options, gGeom.map(vertices, options.ancestors, vertexColors(options)));
+			if (!gGeom.unmap())
+			{
+				throw std::runtime_error("the mapped buffers were lost");
+			}
+		}
+		else
+		{
+			gGeom.setVerts(geom.verts);
+			gGeom.setCols(geom.cols);
+			gGeom.setShades(geom.shades);
+			gGeom.setAncestors(geom.ancestors);
+		}
+		glFinish();
+	};
+	upload(); // warm-up, the first upload allocates the buffers
+	std::vector<double> uploadMs;
+	for (int i = 0; i < options.repeat; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		upload();
+		uploadMs.push_back(msSince(start));
+	}
+	report.uploadMs = summarize(uploadMs);
+	report.uploadSamples = uploadMs;
+
+	if (!options.render)
+	{
+		report.gpuPeakRss = MemoryStats::peakRss();
+		return;
+	}
+
+	Framebuffer target(GL_RGBA8, GL_NEAREST);
+	target.resize(glm::ivec2(options.size));
+	target.bind();
+	glViewport(0, 0, options.size, options.size);
+
+	const bool derived = vertexColors(options) != VertexColors::PerVertex;
+	ShaderProgram shader(
+		AssetPath::Instance()->Get(derived ? "shaders/derived_color.vert" : "shaders/basic.vert"),
+		AssetPath::Instance()->Get(derived ? "shaders/derived_color.frag" : "shaders/basic.frag"));
+	shader.use();
+	glUniform1f(glGetUniformLocation(shader, "morph"), 1.0f);
+	if (derived)
+	{
+		glUniform1i(glGetUniformLocation(shader, "fractal"), fractalIndex(options.fractal));
+		glUniform1i(glGetUniformLocation(shader, "maxDepth"), options.depth);
+		glUniform1i(glGetUniformLocation(shader, "palette"), -1);
+		glProvokingVertex(GL_FIRST_VERTEX_CONVENTION);
+	}
+
+	const GLenum mode = options.fractal == Fractal::Sierpinski ? GL_TRIANGLES : GL_LINES;
+	const GLsizei count = static_cast<GLsizei>(vertices);
+	auto drawVertices = [&]()
+	{
+		shader.use();
+		gGeom.bind();
+		glDrawArrays(mode, 0, count);
+	};
+
+	std::function<void()> drawSource = drawVertices;
+	std::unique_ptr<ShaderProgram> proceduralShader;
+	VertexArray emptyVao;
+	std::unique_ptr<ComputeFractals> computeFractals;
+	std::unique_ptr<GpuSubdivision> subdivision;
+	CPU_Geometry coarse;
+	if (options.source == Source::Procedural)
+	{ // the uniforms the main window sets for its "Vertex Shader" source, with the default tree
+		const TreeParams params;
+		const float angle = glm::radians(params.angle);
+		proceduralShader = std::make_unique<ShaderProgram>(
+			AssetPath::Instance()->Get("shaders/procedural.vert"),
+			AssetPath::Instance()->Get("shaders/basic.frag"));
+		proceduralShader->use();
+		glUniform1i(glGetUniformLocation(*proceduralShader, "fractal"), fractalIndex(options.fractal));
+		glUniform1i(glGetUniformLocation(*proceduralShader, "depth"), options.depth);
+		glUniform1f(glGetUniformLocation(*proceduralShader, "cosA"), std::cos(angle));
+		glUniform1f(glGetUniformLocation(*proceduralShader, "sinA"), std::sin(angle));
+		glUniform1f(glGetUniformLocation(*proceduralShader, "scale"), params.scale);
+		glUniform1f(glGetUniformLocation(*proceduralShader, "branchPoint"), params.branchPoint);
+		glUniform1f(glGetUniformLocation(*proceduralShader, "morph"), 1.0f);
+		drawSource = [&]()
+		{
+			proceduralShader->use();
+			emptyVao.bind();
+			glDrawArrays(mode, 0, count);
+		};
+	}
+	else if (options.source == Source::Compute && computeBackendAvailable())
+	{
+		computeFractals = std::make_unique<ComputeFractals>();
+		computeFractals->generate(fractalIndex(options.fractal), options.depth, TreeParams());
+		drawSource = [&]()
+		{
+			computeFractals->draw(mode);
+		};
+	}
+	else if (options.source == Source::Subdivide)
+	{ // the window's "Subdivide On GPU": the CPU goes as deep as depth - gpuLevels, the GPU does the rest
+		Options coarseOptions = options;
+		coarseOptions.depth = options.depth - options.gpuLevels;
+		coarseOptions.ancestors = false;
+		std::vector<double> coarseMs;
+		generate(coarseOptions, coarse); // warm-up
+		for (int i = 0; i < options.repeat; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			generate(coarseOptions, coarse);
+			coarseMs.push_back(msSince(start));
+		}
+		report.coarseGenerateMs = summarize(coarseMs);
+		report.coarseBytes = coarse.verts.size() * bytesPerVertex(coarseOptions);
+
+		subdivision = std::make_unique<GpuSubdivision>();
+		auto subdivide = [&]()
+		{
+			subdivision->run(coarse, mode, options.gpuLevels);
+			glFinish();
+		};
+		subdivide(); // warm-up, allocates both sides and compiles the shaders for the GPU
+		std::vector<double> subdivideMs;
+		for (int i = 0; i < options.repeat; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			subdivide();
+			subdivideMs.push_back(msSince(start));
+		}
+		report.subdivideMs = summarize(subdivideMs);
+		report.subdivideSamples = subdivideMs;
+		drawSource = [&]()
+		{
+			shader.use();
+			subdivision->draw(mode);
+		};
+	}
+	else if (options.source == Source::Compute)
+	{ // the main window's "Compute Shader" source uploads from the CPU here too, so the comparison is with itself
+		report.computeFallback = fmt::format(
+			"unavailable on OpenGL {}{}, drew the uploaded vertices",
+			reinterpret_cast<const char *>(glGetString(GL_VERSION)),
+#ifdef GL_VERSION_4_3
+			""
+#else
+			" with the 3.3 loader (needs -DFRACTAL_GL46=ON)"
+#endif
+		);
+	}
+
+	auto drawFrame = [&]()
+	{
+		glClear(GL_COLOR_BUFFER_BIT);
+		drawSource();
+		glFinish();
+	};
+	drawFrame(); // warm-up, the driver compiles the shaders for the GPU at the first draw
+	std::vector<double> frameMs;
+	for (int frame = 0; frame < options.frames; frame++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		drawFrame();
+		frameMs.push_back(msSince(start));
+	}
+	report.frameMs = summarize(frameMs);
+	report.frameSamples = frameMs;
+
+	if (options.source != Source::Vertices)
+	{ // the last frame against the same fractal drawn from the uploaded vertices, exactly
+		const std::vector<std::uint8_t> drawn = readPixels(options.size);
+		glClear(GL_COLOR_BUFFER_BIT);
+		drawVertices();
+		const std::vector<std::uint8_t> expected = readPixels(options.size);
+		report.comparedPixels = drawn.size() / 4;
+		for (size_t pixel = 0; pixel < report.comparedPixels; pixel++)
+		{
+			if (!std::equal(drawn.begin() + pixel * 4, drawn.begin() + pixel * 4 + 4, expected.begin() + pixel * 4))
+			{
+				report.differingPixels++;
+			}
+		}
+	}
+	GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+	report.gpuPeakRss = MemoryStats::peakRss();
+}
+
+// One Bench::Result per stage, named fractal-bench/<fractal>/<depth>/<stage>
+std::vector<Bench::Result> sampleResults(const Options &options, const Report &report)
+{
+	std::vector<Bench::Result> results;
+	const std::string prefix = fmt::format("fractal-bench/{}/{}", options.fractalName, options.depth);
+	auto add = [&](const char *stage, const std::vector<double> &ms, double items)
+	{
+		if (ms.empty())
+		{
+			return;
+		}
+		Bench::Result result;
+		result.name = prefix + "/" + stage;
+		result.itemsPerIteration = items;
+		result.iterations = 1;
+		for (double sample : ms)
+		{
+			result.samples.push_back(sample * 1e6);
+		}
+		Bench::summarize(result);
+		results.push_back(std::move(result));
+	};
+	add("generate", report.generateSamples, static_cast<double>(report.vertices));
+	add("upload", report.uploadSamples, static_cast<double>(report.bytes));
+	add("frame", report.frameSamples, static_cast<double>(report.vertices));
+	add("subdivide", report.subdivideSamples, static_cast<double>(report.vertices));
+	return results;
+}
+
+std::string timingsJson(const Timings &timings)
+{
+	return fmt::format(R"({{"min": {:.4f}, "median": {:.4f}, "max": {:.4f}}})", timings.min, timings.median, timings.max);
+}
+
+std::string formatReport(const Options &options, const Report &report)
+{
+	const char *colors = options.shaderColors ? "shader" : "vec3";
+	if (options.json)
+	{
+		std::string json = fmt::format(
+			"{{\n"
+			"  \"fractal\": \"{}\",\n  \"depth\": {},\n  \"threads\": {},\n  \"repeat\": {},\n"
+			"  \"colors\": \"{}\",\n  \"ancestors\": {},\n"
+			"  \"vertices\": {},\n  \"bytes\": {},\n"
+			"  \"generate_ms\": {},\n  \"generate_wall_ms\": {:.4f},\n  \"vertices_per_sec\": {:.1f},\n",
+			options.fractalName, options.depth, options.threads, options.repeat, colors, options.ancestors,
+			report.vertices, report.bytes, timingsJson(report.generateMs), report.generateWallMs, report.verticesPerSec);
+		if (options.upload)
+		{
+			json += fmt::format("  \"renderer\": \"{}\",\n  \"upload\": \"{}\",\n  \"upload_ms\": {},\n  \"gpu_peak_rss_bytes\": {},\n",
+								report.renderer, options.mapped ? "mapped" : "copy", timingsJson(report.uploadMs),
+								report.gpuPeakRss);
+		}
+		if (options.render)
+		{
+			json += fmt::format("  \"frames\": {},\n  \"size\": {},\n  \"frame_ms\": {},\n  \"source\": \"{}\",\n",
+								options.frames, options.size, timingsJson(report.frameMs), options.sourceName);
+		}
+		if (options.source != Source::Vertices)
+		{
+			json += fmt::format("  \"compared_pixels\": {},\n  \"differing_pixels\": {},\n", report.comparedPixels,
+								report.differingPixels);
+		}
+		if (options.source == Source::Compute)
+		{
+			json += fmt::format("  \"compute_fallback\": {},\n", !report.computeFallback.empty());
+		}
+		if (options.source == Source::Subdivide)
+		{
+			json += fmt::format("  \"gpu_levels\": {},\n  \"coarse_bytes\": {},\n  \"coarse_generate_ms\": {},\n"
+								"  \"subdivide_ms\": {},\n",
+								options.gpuLevels, report.coarseBytes, timingsJson(report.coarseGenerateMs),
+								timingsJson(report.subdivideMs));
+		}
+		json += fmt::format("  \"wall_ms\": {:.4f},\n  \"peak_rss_bytes\": {}\n}}\n", report.wallMs, report.peakRss);
+		return json;
+	}
+
+	std::string text = fmt::format(
+		"{} depth {}, {} vertices ({} bytes, {} colours{})\n"
+		"generate: {:.3f} ms median ({:.3f} min, {:.3f} max) over {} x {} thread(s), {:.3g} vertices/s\n",
+		options.fractalName, options.depth, report.vertices, report.bytes, colors, options.ancestors ? ", ancestors" : "",
+		report.generateMs.median, report.generateMs.min, report.generateMs.max, options.repeat, options.threads,
+		report.verticesPerSec);
+	if (options.upload)
+	{
+		text += fmt::format("upload{}: {:.3f} ms median ({:.3f} min, {:.3f} max) on {}, peak RSS from here on: {:.1f} MB\n",
+							options.mapped ? " (mapped, generating into it)" : "", report.uploadMs.median,
+							report.uploadMs.min, report.uploadMs.max, report.renderer, report.gpuPeakRss / (1024.0 * 1024.0));
+	}
+	if (options.render)
+	{
+		text += fmt::format("frame: {:.3f} ms median ({:.3f} min, {:.3f} max) over {} frames at {}x{} from {}\n",
+							report.frameMs.median, report.frameMs.min, report.frameMs.max, options.frames, options.size,
+							options.size, report.computeFallback.empty() ? options.sourceName : "vertices");
+	}
+	if (options.source != Source::Vertices)
+	{
+		text += fmt::format("compare: {} of {} pixels differ from the uploaded vertices\n", report.differingPixels,
+							report.comparedPixels);
+	}
+	if (!report.computeFallback.empty())
+	{
+		text += fmt::format("compute: {}\n", report.computeFallback);
+	}
+	if (options.source == Source::Subdivide)
+	{
+		text += fmt::format("subdivide: depth {} on the CPU, {:.3f} ms median and {} bytes, then {} GPU level(s): "
+							"{:.3f} ms median ({:.3f} min, {:.3f} max) to upload and subdivide\n",
+							options.depth - options.gpuLevels, report.coarseGenerateMs.median, report.coarseBytes,
+							options.gpuLevels, report.subdivideMs.median, report.subdivideMs.min, report.subdivideMs.max);
+	}
+	text += fmt::format("wall: {:.1f} ms, peak RSS: {:.1f} MB\n", report.wallMs, report.peakRss / (1024.0 * 1024.0));
+	return text;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	if (argh::parser(argc, argv)[{"-h", "--help"}])
+	{
+		std::fputs(usage, stdout);
+		return 0;
+	}
+
+	Options options;
+	try
+	{
+		options = parseOptions(argc, argv);
+	}
+	catch (const std::invalid_argument &e)
+	{
+		std::fprintf(stderr, "fractal-bench: %s\n\n%s", e.what(), usage);
+		return 1;
+	}
+
+	Bench::warnIfUnoptimized("fractal-bench");
+	auto wallStart = std::chrono::steady_clock::now();
+	// Linux overcommits, so a run that doesn't fit isn't a bad_alloc but the kernel killing the process
+	// halfway. Every thread's copy, plus the uploaded one (llvmpipe's buffers are in system memory)
+	const size_t needed = vertexCount(options.fractal, options.depth) * bytesPerVertex(options) *
+						  (options.threads + (options.upload ? 1 : 0));
+	const size_t available = MemoryStats::availableMemory();
+	if (available > 0 && needed > available)
+	{
+		std::fprintf(stderr, "fractal-bench: %s depth %d needs about %.1f GB with %d thread(s), %.1f GB is available\n",
+					 options.fractalName.c_str(), options.depth, needed / 1e9, options.threads, available / 1e9);
+		return 4;
+	}
+
+	Report report;
+	try
+	{
+		CPU_Geometry geom;
+		benchmarkGeneration(options, report, geom);
+
+		if (options.upload)
+		{
+			if (options.mapped)
+			{ // nothing on the CPU, like the window's "Generate Into GPU Memory"
+				geom.release();
+			}
+			try
+			{
+				HeadlessContext context("fractal-bench", options.software);
+				benchmarkGpu(options, report, geom);
+			}
+			catch (const std::runtime_error &e)
+			{ // no context, or the shaders or framebuffer failed
+				std::fprintf(stderr, "fractal-bench: %s\n", e.what());
+				return 2;
+			}
+		}
+	}
+	catch (const std::bad_alloc &)
+	{ // every thread holds its own copy, and the readbacks of --source are another two images
+		std::fprintf(stderr, "fractal-bench: out of memory for %s depth %d with %d thread(s)\n", options.fractalName.c_str(),
+					 options.depth, options.threads);
+		return 4;
+	}
+	report.wallMs = msSince(wallStart);
+	report.peakRss = std::max(report.peakRss, MemoryStats::peakRss());
+
+	const std::string text = formatReport(options, report);
+	if (options.out.empty())
+	{
+		std::fputs(text.c_str(), stdout);
+	}
+	else
+	{
+		std::FILE *file = std::fopen(options.out.c_str(), "w");
+		if (file == nullptr)
+		{
+			std::fprintf(stderr, "fractal-bench: can't write %s\n", options.out.c_str());
+			return 1;
+		}
+		std::fputs(text.c_str(), file);
+		std::fclose(file);
+	}
+	if (!options.samples.empty() &&
+		!Bench::write(options.samples, Bench::toJson("fractal-bench", sampleResults(options, report))))
+	{
+		std::fprintf(stderr, "fractal-bench: can't write %s\n", options.samples.c_str());
+		return 1;
+	}
+	if (report.differingPixels > 0)
+	{
+		std::fprintf(stderr, "fractal-bench: %zu pixels drawn from %s differ from the uploaded vertices\n",
+					 report.differingPixels, options.sourceName.c_str());
+		return 3;
+	}
+
+	return 0;
+}
@@ -0,0 +1,164 @@
+#include "HeadlessContext.h"
+
+#include "GLState.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef FRACTAL_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+
+namespace {
+
+	std::unique_ptr<Window> hiddenWindow(const char *tool)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		try
+		{
+			return std::make_unique<Window>(1, 1, tool);
+		}
+		catch (const std::runtime_error &)
+		{
+			return nullptr;
+		}
+	}
+
+}
+
+
+HeadlessContext::HeadlessContext(const char *tool, bool software)
+{
+	if (software)
+	{
+		// read by Mesa's GLX and EGL when the context is created
+#if defined(_WIN32)
+		_putenv_s("LIBGL_ALWAYS_SOFTWARE", "1");
+#else
+		setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+#endif
+	}
+
+	if (glfwInit())
+	{
+		window = hiddenWindow(tool);
+		if (window != nullptr)
+		{
+			contextKind = "window";
+			return;
+		}
+		glfwTerminate();
+	}
+
+	if (createEgl())
+	{
+		contextKind = "egl";
+		return;
+	}
+
+	std::fprintf(stderr, "%s: no display and no EGL, trying an OSMesa context\n", tool);
+	glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+	if (glfwInit())
+	{
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		window = hiddenWindow(tool);
+	}
+	if (window == nullptr)
+	{
+		destroy(); // the destructor won't run
+		throw std::runtime_error("no OpenGL context: no display, no EGL and no OSMesa");
+	}
+	contextKind = "osmesa";
+}
+
+
+HeadlessContext::~HeadlessContext()
+{
+	destroy();
+}
+
+
+void HeadlessContext::destroy()
+{
+	window.reset(); // before GLFW goes
+	glfwTerminate();
+#ifdef FRACTAL_HEADLESS_EGL
+	if (eglDisplay != nullptr)
+	{
+		eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (eglContext != nullptr)
+		{
+			eglDestroyContext(eglDisplay, eglContext);
+		}
+		eglTerminate(eglDisplay);
+		eglDisplay = nullptr;
+		eglContext = nullptr;
+	}
+#endif
+}
+
+
+bool HeadlessContext::createEgl()
+{
+#ifdef FRACTAL_HEADLESS_EGL
+	auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (getPlatformDisplay == nullptr)
+	{
+		return false;
+	}
+	EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		return false;
+	}
+	eglDisplay = display;
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		return false;
+	}
+
+	// nothing is drawn to a surface, so any config will do, or none (EGL_KHR_no_config_context)
+	const EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+	EGLConfig config = nullptr;
+	EGLint configs = 0;
+	eglChooseConfig(display, configAttributes, &config, 1, &configs);
+
+	// the same versions the window asks for, a 4.3 context where the loader can use it
+	const EGLint versions[][2] = {
+#ifdef GL_VERSION_4_3
+		{4, 3},
+#endif
+		{3, 3}};
+	for (const EGLint *version : versions)
+	{
+		const EGLint contextAttributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, version[0],
+			EGL_CONTEXT_MINOR_VERSION, version[1],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE};
+		EGLContext context = eglCreateContext(display, configs > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+		if (context != EGL_NO_CONTEXT)
+		{
+			eglContext = context;
+			break;
+		}
+	}
+	// without a surface the context can only render into framebuffer objects (EGL_KHR_surfaceless_context)
+	if (eglContext == nullptr || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+	{
+		return false;
+	}
+	if (gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)) == 0)
+	{
+		return false;
+	}
+	GLState::invalidate(); // a new context, nothing it has set is known yet
+	return true;
+#else
+	return false;
+#endif
+}
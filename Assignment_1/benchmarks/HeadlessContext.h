@@ -0,0 +1,41 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// An OpenGL context for the benchmark tools, which have to run on machines with
+// no display (build servers). Tries, in order:
+//   - a hidden window, where there is a display
+//   - an EGL context with no surface at all (Mesa's surfaceless platform), in
+//     Linux builds that found EGL (FRACTAL_HEADLESS_EGL)
+//   - an OSMesa context on GLFW's null platform (needs libOSMesa at run time)
+// There is no default framebuffer in the last two, so render into a Framebuffer.
+//------------------------------------------------------------------------------
+
+#include "Window.h"
+
+#include <memory>
+#include <string>
+
+class HeadlessContext
+{
+public:
+	// Current and loaded (glad) when this returns, throws std::runtime_error if nothing worked.
+	// tool names the program in the messages. software asks Mesa for its llvmpipe rasterizer
+	// even where there is a GPU, so the results compare between machines (LIBGL_ALWAYS_SOFTWARE)
+	HeadlessContext(const char *tool, bool software = false);
+	~HeadlessContext(); // also terminates GLFW
+
+	HeadlessContext(const HeadlessContext &) = delete;
+	HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+	// "window", "egl" or "osmesa"
+	const std::string &kind() const { return contextKind; }
+
+private:
+	bool createEgl();
+	void destroy();
+
+	std::unique_ptr<Window> window;
+	void *eglDisplay = nullptr; // EGLDisplay and EGLContext, kept out of the header
+	void *eglContext = nullptr;
+	std::string contextKind;
+};
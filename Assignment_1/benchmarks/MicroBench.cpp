@@ -0,0 +1,352 @@
+//------------------------------------------------------------------------------
+// fractal-microbench: microbenchmarks of the CPU side, with no window and no
+// OpenGL (it doesn't link GLFW), so it runs on any machine, build servers too.
+//
+//   generate/...  every generator across depths, into reused memory
+//   vector/...    ways of growing the vertex array: push_back, reserve, resize,
+//                 the GeometryArena and a monotonic buffer
+//   midpoint/...  the generators' two kernels over arrays of vec3: the midpoint
+//   rotate/...    and the tree's branch rotation. glm's vec3 (array of structs)
+//                 against plain float arrays (struct of arrays, which compilers
+//                 vectorize at -O3) and SSE intrinsics where the target has them
+//
+// Prints a table, --json <path> (or - for stdout) writes every sample as JSON for
+// comparing runs. --filter <text> runs only the benchmarks whose name contains it.
+//------------------------------------------------------------------------------
+
+#include "Bench.h"
+
+#include "Fractals.h"
+#include "GeometryArena.h"
+
+#include <argh.h>
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRACTAL_BENCH_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+// --- Generators ---
+
+void generatorBenchmarks(std::vector<Bench::Result> &results, const Bench::Options &options)
+{
+	CPU_Geometry geom; // reused, so after the first iteration this measures the generator and not the allocator
+	for (int depth = 0; depth <= 10; depth += 2)
+	{
+		Bench::run(results, options, fmt::format("generate/sierpinski/{}", depth), sierpinskiVertexCount(depth),
+				   [&] { generateSierpinskiTriangle(geom, depth); Bench::keep(geom.verts.data()); });
+	}
+	for (int depth = 2; depth <= 18; depth += 4)
+	{
+		Bench::run(results, options, fmt::format("generate/levy/{}", depth), levyVertexCount(depth),
+				   [&] { generateLevyCurve(geom, depth); Bench::keep(geom.verts.data()); });
+	}
+	for (int depth = 2; depth <= 10; depth += 2)
+	{
+		Bench::run(results, options, fmt::format("generate/tree/{}", depth), treeVertexCount(depth),
+				   [&] { generateTree(geom, depth); Bench::keep(geom.verts.data()); });
+	}
+
+	// the same with the depth morph's ancestors, the most the generators write
+	Bench::run(results, options, "generate/levy/16/ancestors", levyVertexCount(16),
+			   [&] { generateLevyCurve(geom, 16, true); Bench::keep(geom.verts.data()); });
+	geom.release();
+}
+
+// --- Vector Growth ---
+
+// A depth 16 Levy curve's worth of vertices, written one at a time like the recursive generators used to
+constexpr size_t growthCount = size_t(1) << 17;
+
+void vectorBenchmarks(std::vector<Bench::Result> &results, const Bench::Options &options)
+{
+	const glm::vec3 value(0.25f, 0.5f, 0.0f);
+
+	Bench::run(results, options, "vector/push_back", growthCount, [&] {
+		std::vector<glm::vec3> verts;
+		for (size_t i = 0; i < growthCount; i++)
+		{
+			verts.push_back(value);
+		}
+		Bench::keep(verts.data());
+	});
+	Bench::run(results, options, "vector/reserve_push_back", growthCount, [&] {
+		std::vector<glm::vec3> verts;
+		verts.reserve(growthCount);
+		for (size_t i = 0; i < growthCount; i++)
+		{
+			verts.push_back(value);
+		}
+		Bench::keep(verts.data());
+	});
+	Bench::run(results, options, "vector/resize_index", growthCount, [&] {
+		std::vector<glm::vec3> verts(growthCount);
+		for (size_t i = 0; i < growthCount; i++)
+		{
+			verts[i] = value;
+		}
+		Bench::keep(verts.data());
+	});
+
+	GeometryArena arena; // what the main window's CPU_Geometry allocates from
+	Bench::run(results, options, "vector/geometry_arena", growthCount, [&] {
+		{
+			std::pmr::vector<glm::vec3> verts(&arena);
+			verts.resize(growthCount);
+			for (size_t i = 0; i < growthCount; i++)
+			{
+				verts[i] = value;
+			}
+			Bench::keep(verts.data());
+		}
+		arena.reset();
+	});
+
+	std::vector<std::byte> buffer(growthCount * sizeof(glm::vec3) * 2);
+	Bench::run(results, options, "vector/monotonic_push_back", growthCount, [&] {
+		std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+		std::pmr::vector<glm::vec3> verts(&resource);
+		for (size_t i = 0; i < growthCount; i++)
+		{
+			verts.push_back(value);
+		}
+		Bench::keep(verts.data());
+	});
+}
+
+// --- Math Kernels ---
+
+constexpr size_t kernelCount = size_t(1) << 16;
+
+// The same points in both layouts
+struct Points
+{
+	std::vector<glm::vec3> a, b, out;
+	std::vector<float> ax, ay, az, bx, by, bz, ox, oy, oz;
+
+	Points()
+		: a(kernelCount), b(kernelCount), out(kernelCount), ax(kernelCount), ay(kernelCount), az(kernelCount),
+		  bx(kernelCount), by(kernelCount), bz(kernelCount), ox(kernelCount), oy(kernelCount), oz(kernelCount)
+	{
+		for (size_t i = 0; i < kernelCount; i++)
+		{ // anything that isn't constant
+			float t = static_cast<float>(i) / kernelCount;
+			a[i] = glm::vec3(t, 1.0f - t, 0.0f);
+			b[i] = glm::vec3(std::sin(t * 7.0f), std::cos(t * 3.0f), 0.0f);
+			ax[i] = a[i].x, ay[i] = a[i].y, az[i] = a[i].z;
+			bx[i] = b[i].x, by[i] = b[i].y, bz[i] = b[i].z;
+		}
+	}
+};
+
+// The tree's rotation of a unit direction by +angle, scaled to the child's length
+constexpr float cosA = 0.9010770f; // 25.7 degrees
+constexpr float sinA = 0.4336591f;
+constexpr float childLength = 0.5f;
+
+void midpointGlm(Points &p)
+{
+	for (size_t i = 0; i < kernelCount; i++)
+	{
+		p.out[i] = (p.a[i] + p.b[i]) / 2.0f;
+	}
+}
+
+void midpointSoa(Points &p)
+{
+	for (size_t i = 0; i < kernelCount; i++)
+	{
+		p.ox[i] = (p.ax[i] + p.bx[i]) * 0.5f;
+		p.oy[i] = (p.ay[i] + p.by[i]) * 0.5f;
+		p.oz[i] = (p.az[i] + p.bz[i]) * 0.5f;
+	}
+}
+
+void rotateGlm(Points &p)
+{
+	for (size_t i = 0; i < kernelCount; i++)
+	{
+		const glm::vec3 &d = p.a[i];
+		p.out[i] = glm::vec3(d.x * cosA - d.y * sinA, d.x * sinA + d.y * cosA, 0.0f) * childLength;
+	}
+}
+
+void rotateSoa(Points &p)
+{
+	for (size_t i = 0; i < kernelCount; i++)
+	{
+		p.ox[i] = (p.ax[i] * cosA - p.ay[i] * sinA) * childLength;
+		p.oy[i] = (p.ax[i] * sinA + p.ay[i] * cosA) * childLength;
+		p.oz[i] = 0.0f;
+	}
+}
+
+#ifdef FRACTAL_BENCH_SSE
+// Four points at a time. kernelCount is a multiple of 4, so there is no remainder
+void midpointSse(Points &p)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+	const float *in[3][2] = {{p.ax.data(), p.bx.data()}, {p.ay.data(), p.by.data()}, {p.az.data(), p.bz.data()}};
+	float *out[3] = {p.ox.data(), p.oy.data(), p.oz.data()};
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (size_t i = 0; i < kernelCount; i += 4)
+		{
+			__m128 sum = _mm_add_ps(_mm_loadu_ps(in[axis][0] + i), _mm_loadu_ps(in[axis][1] + i));
+			_mm_storeu_ps(out[axis] + i, _mm_mul_ps(sum, half));
+		}
+	}
+}
+
+void rotateSse(Points &p)
+{
+	const __m128 c = _mm_set1_ps(cosA);
+	const __m128 s = _mm_set1_ps(sinA);
+	const __m128 length = _mm_set1_ps(childLength);
+	const __m128 zero = _mm_setzero_ps();
+	for (size_t i = 0; i < kernelCount; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(p.ax.data() + i);
+		__m128 y = _mm_loadu_ps(p.ay.data() + i);
+		// the same operations in the same order as the scalar versions, so the results match exactly
+		__m128 rx = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(x, c), _mm_mul_ps(y, s)), length);
+		__m128 ry = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(x, s), _mm_mul_ps(y, c)), length);
+		_mm_storeu_ps(p.ox.data() + i, rx);
+		_mm_storeu_ps(p.oy.data() + i, ry);
+		_mm_storeu_ps(p.oz.data() + i, zero);
+	}
+}
+#endif
+
+// The struct of arrays result against the glm one, the largest difference
+float compare(const Points &p)
+{
+	float worst = 0.0f;
+	for (size_t i = 0; i < kernelCount; i++)
+	{
+		worst = std::max({worst, std::abs(p.out[i].x - p.ox[i]), std::abs(p.out[i].y - p.oy[i]), std::abs(p.out[i].z - p.oz[i])});
+	}
+	return worst;
+}
+
+// Runs every variant once and checks it against glm before timing anything, a fast wrong kernel is no use
+bool checkKernels(Points &p)
+{
+	struct Variant
+	{
+		const char *name;
+		void (*reference)(Points &);
+		void (*kernel)(Points &);
+	};
+	std::vector<Variant> variants = {{"midpoint/soa", midpointGlm, midpointSoa}, {"rotate/soa", rotateGlm, rotateSoa}};
+#ifdef FRACTAL_BENCH_SSE
+	variants.push_back({"midpoint/sse", midpointGlm, midpointSse});
+	variants.push_back({"rotate/sse", rotateGlm, rotateSse});
+#endif
+	bool ok = true;
+	for (const Variant &variant : variants)
+	{
+		variant.reference(p);
+		variant.kernel(p);
+		float error = compare(p);
+		if (error > 1e-6f)
+		{
+			std::fprintf(stderr, "fractal-microbench: %s differs from glm by %g\n", variant.name, error);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+void kernelBenchmarks(std::vector<Bench::Result> &results, const Bench::Options &options, Points &p)
+{
+	Bench::run(results, options, "midpoint/glm_aos", kernelCount, [&] { midpointGlm(p); Bench::keep(p.out.data()); });
+	Bench::run(results, options, "midpoint/soa", kernelCount, [&] { midpointSoa(p); Bench::keep(p.ox.data()); });
+#ifdef FRACTAL_BENCH_SSE
+	Bench::run(results, options, "midpoint/sse", kernelCount, [&] { midpointSse(p); Bench::keep(p.ox.data()); });
+#endif
+	Bench::run(results, options, "rotate/glm_aos", kernelCount, [&] { rotateGlm(p); Bench::keep(p.out.data()); });
+	Bench::run(results, options, "rotate/soa", kernelCount, [&] { rotateSoa(p); Bench::keep(p.ox.data()); });
+#ifdef FRACTAL_BENCH_SSE
+	Bench::run(results, options, "rotate/sse", kernelCount, [&] { rotateSse(p); Bench::keep(p.ox.data()); });
+#endif
+}
+
+const char *usage = R"(fractal-microbench: microbenchmarks of the generators, vertex arrays and math kernels
+
+  --filter <text>         only benchmarks whose name contains text (e.g. generate/levy)
+  --repetitions <n>       timed samples per benchmark (default 20)
+  --min-sample-ms <ms>    how long one sample runs at least (default 2)
+  --json <path>           also write every sample as JSON, - for stdout (the table goes to stderr then)
+  --list                  print the benchmark names and exit
+)";
+
+}
+
+int main(int argc, char **argv)
+{
+	argh::parser cmdl({"--filter", "--repetitions", "--min-sample-ms", "--json"});
+	cmdl.parse(argc, argv);
+	if (cmdl[{"-h", "--help"}])
+	{
+		std::fputs(usage, stdout);
+		return 0;
+	}
+
+	Bench::warnIfUnoptimized("fractal-microbench");
+	Bench::Options options;
+	cmdl("--filter") >> options.filter;
+	if (!(cmdl("--repetitions", options.repetitions) >> options.repetitions) || options.repetitions < 1 ||
+		!(cmdl("--min-sample-ms", options.minSampleMs) >> options.minSampleMs) || options.minSampleMs < 0.0)
+	{
+		std::fprintf(stderr, "fractal-microbench: bad --repetitions or --min-sample-ms\n\n%s", usage);
+		return 1;
+	}
+	std::string jsonPath;
+	cmdl("--json") >> jsonPath;
+
+	if (cmdl["--list"])
+	{ // the names are only known once a benchmark runs, so run each one once, as briefly as possible
+		options.repetitions = 1;
+		options.minSampleMs = 0.0;
+	}
+
+	Points points;
+	if (!checkKernels(points))
+	{
+		return 1;
+	}
+
+	std::vector<Bench::Result> results;
+	generatorBenchmarks(results, options);
+	vectorBenchmarks(results, options);
+	kernelBenchmarks(results, options, points);
+
+	if (cmdl["--list"])
+	{
+		for (const Bench::Result &result : results)
+		{
+			std::printf("%s\n", result.name.c_str());
+		}
+		return 0;
+	}
+
+	const std::string table = Bench::toText(results);
+	std::fputs(table.c_str(), jsonPath == "-" ? stderr : stdout);
+	if (!jsonPath.empty() && !Bench::write(jsonPath, Bench::toJson("fractal-microbench", results)))
+	{
+		std::fprintf(stderr, "fractal-microbench: can't write %s\n", jsonPath.c_str());
+		return 1;
+	}
+	return 0;
+}
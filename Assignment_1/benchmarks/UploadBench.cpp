@@ -0,0 +1,456 @@
+//------------------------------------------------------------------------------
+// fractal-uploadbench: the ways of getting a frame's vertices into a buffer,
+// compared over buffer sizes from 1 KB up (to 1 GB with --max-mb 1024).
+// VertexBuffer::uploadData re-specifies the buffer with glBufferData every time,
+// this measures what the alternatives would do:
+//
+//   buffer_data_static   glBufferData(data, GL_STATIC_DRAW), what uploadData does today
+//   buffer_data_stream   the same with GL_STREAM_DRAW
+//   orphan_subdata       glBufferData(null) to orphan the old storage, then glBufferSubData
+//   map_invalidate       glMapBufferRange with GL_MAP_INVALIDATE_BUFFER_BIT, what VertexBuffer::map does
+//   map_unsynchronized   a ring of regions in one buffer, mapped with GL_MAP_UNSYNCHRONIZED_BIT,
+//                        fences making sure the GPU is done with a region before it is rewritten
+//   persistent           the same ring, mapped once with glBufferStorage (GL 4.4, so only in the
+//                        FRACTAL_GL46 build on a 4.4+ context)
+//
+// Every frame uploads the whole buffer and draws from it (a few points into a small
+// offscreen framebuffer, so the GPU really reads the new data), and at most two frames
+// are in flight, like a double buffered swap chain: a frame first waits for the one two
+// before it to finish. So a strategy that makes the driver stall or copy shows up in the
+// frame time, which is what is reported, along with the MB/s it amounts to and the CPU
+// time of the upload calls alone.
+//
+// Runs headless (see HeadlessContext.h). --software picks Mesa's llvmpipe, which makes
+// build machines comparable with each other, though not with a real GPU.
+//------------------------------------------------------------------------------
+
+#include "Bench.h"
+#include "HeadlessContext.h"
+
+#include "AssetPath.h"
+#include "Framebuffer.h"
+#include "GLHandles.h"
+#include "GLState.h"
+#include "ShaderProgram.h"
+#include "VertexArray.h"
+
+#include <argh.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+enum class Strategy
+{
+	BufferDataStatic,
+	BufferDataStream,
+	OrphanSubData,
+	MapInvalidate,
+	MapUnsynchronized,
+	Persistent,
+};
+
+const Strategy strategies[] = {Strategy::BufferDataStatic, Strategy::BufferDataStream, Strategy::OrphanSubData,
+							   Strategy::MapInvalidate, Strategy::MapUnsynchronized, Strategy::Persistent};
+
+const char *strategyName(Strategy strategy)
+{
+	switch (strategy)
+	{
+	case Strategy::BufferDataStatic:
+		return "buffer_data_static";
+	case Strategy::BufferDataStream:
+		return "buffer_data_stream";
+	case Strategy::OrphanSubData:
+		return "orphan_subdata";
+	case Strategy::MapInvalidate:
+		return "map_invalidate";
+	case Strategy::MapUnsynchronized:
+		return "map_unsynchronized";
+	case Strategy::Persistent:
+		return "persistent";
+	}
+	return "";
+}
+
+// Frames the GPU may be behind, like a double buffered swap chain
+constexpr int framesInFlight = 2;
+// The ring strategies write each frame into the next region, one more than can be in flight,
+// so the region being written is never one the GPU may still read
+constexpr int ringRegions = framesInFlight + 1;
+
+// A fence per slot, waited on before the slot is reused
+class Fences
+{
+public:
+	Fences() = default;
+	Fences(const Fences &) = delete;
+	Fences &operator=(const Fences &) = delete;
+	~Fences()
+	{
+		for (GLsync &sync : syncs)
+		{
+			glDeleteSync(sync);
+		}
+	}
+
+	void place(int slot)
+	{
+		glDeleteSync(syncs[slot]); // deleting 0 is allowed
+		syncs[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	void wait(int slot)
+	{
+		if (syncs[slot] != nullptr)
+		{ // the flush makes sure the fence is actually submitted, otherwise this could wait forever
+			glClientWaitSync(syncs[slot], GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(10) * 1000 * 1000 * 1000);
+			glDeleteSync(syncs[slot]);
+			syncs[slot] = nullptr;
+		}
+	}
+
+private:
+	GLsync syncs[ringRegions] = {};
+};
+
+bool persistentSupported()
+{
+#ifdef GL_VERSION_4_4
+	return GLAD_GL_VERSION_4_4 != 0;
+#else
+	return false;
+#endif
+}
+
+// Owns the buffer one strategy uploads into. upload() writes a frame's data and returns the byte
+// offset it ended up at (not 0 for the ring strategies)
+class Uploader
+{
+public:
+	Uploader(Strategy strategy, GLsizeiptr size)
+		: strategy(strategy), size(size)
+	{
+		GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+		switch (strategy)
+		{
+		case Strategy::MapInvalidate:
+			glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+			break;
+		case Strategy::MapUnsynchronized:
+			glBufferData(GL_ARRAY_BUFFER, size * ringRegions, nullptr, GL_STREAM_DRAW);
+			break;
+		case Strategy::Persistent:
+#ifdef GL_VERSION_4_4
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_ARRAY_BUFFER, size * ringRegions, nullptr, flags);
+			if (glGetError() == GL_NO_ERROR)
+			{
+				persistent = static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size * ringRegions, flags));
+			}
+		}
+#endif
+			break;
+		default: // allocated by every upload
+			break;
+		}
+		// the big sizes may not fit, the ring needs three times the size
+		ok = glGetError() == GL_NO_ERROR && (strategy != Strategy::Persistent || persistent != nullptr);
+	}
+
+	Uploader(const Uploader &) = delete;
+	Uploader &operator=(const Uploader &) = delete;
+	~Uploader()
+	{
+		if (persistent != nullptr)
+		{
+			GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+	}
+
+	bool valid() const { return ok; }
+	void bind() const { GLState::bindBuffer(GL_ARRAY_BUFFER, buffer); }
+
+	GLintptr upload(const void *data, int frame)
+	{
+		GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+		const int region = frame % ringRegions;
+		const GLintptr offset = size * region;
+		switch (strategy)
+		{
+		case Strategy::BufferDataStatic:
+			glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+			return 0;
+		case Strategy::BufferDataStream:
+			glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW);
+			return 0;
+		case Strategy::OrphanSubData:
+			glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+			return 0;
+		case Strategy::MapInvalidate:
+			write(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT), data);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			return 0;
+		case Strategy::MapUnsynchronized:
+			regionFences.wait(region);
+			write(glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+								   GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT),
+				  data);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			return offset;
+		case Strategy::Persistent:
+			regionFences.wait(region);
+			std::memcpy(persistent + offset, data, size); // coherent, visible to the GPU without a flush
+			return offset;
+		}
+		return 0;
+	}
+
+	// After the draw that reads this frame's region, so the region isn't rewritten before it's done
+	void drawn(int frame)
+	{
+		if (strategy == Strategy::MapUnsynchronized || strategy == Strategy::Persistent)
+		{
+			regionFences.place(frame % ringRegions);
+		}
+	}
+
+private:
+	void write(void *destination, const void *data)
+	{
+		if (destination != nullptr)
+		{
+			std::memcpy(destination, data, size);
+		}
+	}
+
+	Strategy strategy;
+	GLsizeiptr size;
+	VertexBufferHandle buffer;
+	char *persistent = nullptr;
+	Fences regionFences;
+	bool ok = false;
+};
+
+struct Options
+{
+	size_t minBytes = 1024;
+	size_t maxBytes = size_t(64) << 20;
+	int frames = 60; // timed, fewer for the big sizes (see framesFor)
+	bool software = false;
+	std::string filter;
+	std::string json;
+};
+
+// Enough frames for a stable median, without copying more than a few GB for the big sizes
+int framesFor(const Options &options, size_t bytes)
+{
+	const size_t budget = size_t(4) << 30;
+	return static_cast<int>(std::clamp<size_t>(budget / bytes, 5, options.frames));
+}
+
+std::string sizeLabel(size_t bytes)
+{
+	if (bytes >= (size_t(1) << 30))
+	{
+		return fmt::format("{}G", bytes >> 30);
+	}
+	if (bytes >= (size_t(1) << 20))
+	{
+		return fmt::format("{}M", bytes >> 20);
+	}
+	return fmt::format("{}K", bytes >> 10);
+}
+
+double nsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One strategy at one size. False when the buffer couldn't be allocated
+bool measure(Strategy strategy, size_t bytes, const Options &options, const std::vector<char> &source,
+			 std::vector<Bench::Result> &results)
+{
+	Uploader uploader(strategy, static_cast<GLsizeiptr>(bytes));
+	if (!uploader.valid())
+	{
+		return false;
+	}
+	VertexArray vao;
+	vao.bind();
+	glEnableVertexAttribArray(0);
+	// a sample of the vertices in the buffer, enough that the GPU has to read it, not so many that drawing dominates
+	const GLsizei points = static_cast<GLsizei>(std::min<size_t>(bytes / sizeof(float[3]), 1024));
+
+	const int warmUp = ringRegions;
+	const int frames = framesFor(options, bytes);
+	Fences frameFences;
+	std::vector<double> frameNs;
+	std::vector<double> submitNs;
+	auto frameStart = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < warmUp + frames; frame++)
+	{
+		frameFences.wait(frame % framesInFlight); // the frame two back, like waiting for a swap
+		if (frame > warmUp)
+		{ // the previous frame, from its start to this frame's start
+			frameNs.push_back(nsSince(frameStart));
+		}
+		frameStart = std::chrono::steady_clock::now();
+
+		const GLintptr offset = uploader.upload(source.data(), frame);
+		if (frame >= warmUp)
+		{
+			submitNs.push_back(nsSince(frameStart));
+		}
+		uploader.bind();
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
+		glDrawArrays(GL_POINTS, 0, points);
+		uploader.drawn(frame);
+		frameFences.place(frame % framesInFlight);
+	}
+	glFinish();
+	frameNs.push_back(nsSince(frameStart));
+
+	Bench::Result result;
+	result.name = fmt::format("upload/{}/{}", strategyName(strategy), sizeLabel(bytes));
+	result.itemsPerIteration = static_cast<double>(bytes); // so items_per_second is bytes per second
+	result.iterations = 1;
+	result.samples = frameNs;
+	Bench::summarize(result);
+	std::sort(submitNs.begin(), submitNs.end());
+	result.metrics = {{"mb_per_second", bytes / (1024.0 * 1024.0) / (result.median * 1e-9)},
+					  {"submit_median", Bench::percentile(submitNs, 50.0)},
+					  {"submit_p95", Bench::percentile(submitNs, 95.0)}};
+	results.push_back(std::move(result));
+
+	const Bench::Result &last = results.back();
+	std::fprintf(stderr, "%-36s %10.3f ms frame %10.1f MB/s\n", last.name.c_str(), last.median * 1e-6,
+				 last.metrics[0].second);
+	return glGetError() == GL_NO_ERROR;
+}
+
+std::string uploadTable(const std::vector<Bench::Result> &results)
+{
+	std::string text = fmt::format("{:<36} {:>12} {:>12} {:>12} {:>12}\n", "benchmark", "frame (ms)", "p95 (ms)",
+								   "submit (ms)", "MB/s");
+	for (const Bench::Result &result : results)
+	{
+		text += fmt::format("{:<36} {:>12.3f} {:>12.3f} {:>12.3f} {:>12.1f}\n", result.name, result.median * 1e-6,
+							result.p95 * 1e-6, result.metrics[1].second * 1e-6, result.metrics[0].second);
+	}
+	return text;
+}
+
+const char *usage = R"(fractal-uploadbench: compares ways of uploading vertex buffers, from 1 KB up
+
+  --max-mb <n>       largest buffer in MB, the sizes go up by 4x from 1 KB (default 64, at most 1024).
+                     The ring strategies allocate 3x that, plus the source data in RAM
+  --frames <n>       timed frames per strategy and size, fewer for the big sizes (default 60)
+  --filter <text>    only strategies and sizes whose name contains text (e.g. persistent, /16M)
+  --software         use Mesa's software rasterizer (llvmpipe) even where there is a GPU
+  --json <path>      also write every frame time as JSON to a file (stdout has the shaders' log lines)
+)";
+
+}
+
+int main(int argc, char **argv)
+{
+	argh::parser cmdl({"--max-mb", "--frames", "--filter", "--json"});
+	cmdl.parse(argc, argv);
+	if (cmdl[{"-h", "--help"}])
+	{
+		std::fputs(usage, stdout);
+		return 0;
+	}
+
+	Options options;
+	size_t maxMb = options.maxBytes >> 20;
+	if (!(cmdl("--max-mb", maxMb) >> maxMb) || maxMb < 1 || maxMb > 1024 ||
+		!(cmdl("--frames", options.frames) >> options.frames) || options.frames < 5)
+	{
+		std::fprintf(stderr, "fractal-uploadbench: --max-mb takes 1 to 1024, --frames at least 5\n\n%s", usage);
+		return 1;
+	}
+	options.maxBytes = maxMb << 20;
+	options.software = cmdl["--software"];
+	cmdl("--filter") >> options.filter;
+	cmdl("--json") >> options.json;
+	Bench::warnIfUnoptimized("fractal-uploadbench");
+
+	std::vector<Bench::Result> results;
+	try
+	{
+		HeadlessContext context("fractal-uploadbench", options.software);
+		std::fprintf(stderr, "fractal-uploadbench: %s, OpenGL %s (%s context)\n",
+					 reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+					 reinterpret_cast<const char *>(glGetString(GL_VERSION)), context.kind().c_str());
+
+		// a small target, the draws are only there to make the GPU read the buffers
+		Framebuffer target(GL_RGBA8, GL_NEAREST);
+		target.resize(glm::ivec2(64));
+		target.bind();
+		glViewport(0, 0, 64, 64);
+		ShaderProgram shader(AssetPath::Instance()->Get("shaders/basic.vert"), AssetPath::Instance()->Get("shaders/basic.frag"));
+		shader.use();
+		glUniform1f(glGetUniformLocation(shader, "morph"), 1.0f);
+
+		// the same (vertex-like) bytes every frame, written once so the copy is all that's measured
+		std::vector<char> source(options.maxBytes);
+		for (size_t i = 0; i < source.size(); i += sizeof(float))
+		{
+			float value = static_cast<float>(i % 4096) / 4096.0f - 0.5f;
+			std::memcpy(source.data() + i, &value, sizeof(float));
+		}
+
+		for (Strategy strategy : strategies)
+		{
+			if (strategy == Strategy::Persistent && !persistentSupported())
+			{
+				std::fprintf(stderr, "fractal-uploadbench: persistent skipped, it needs OpenGL 4.4 and the FRACTAL_GL46 build\n");
+				continue;
+			}
+			for (size_t bytes = options.minBytes; bytes <= options.maxBytes; bytes *= 4)
+			{
+				const std::string name = fmt::format("upload/{}/{}", strategyName(strategy), sizeLabel(bytes));
+				if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+				{
+					continue;
+				}
+				if (!measure(strategy, bytes, options, source, results))
+				{
+					std::fprintf(stderr, "fractal-uploadbench: %s at %s failed (out of memory?), skipping the larger sizes\n",
+								 strategyName(strategy), sizeLabel(bytes).c_str());
+					while (glGetError() != GL_NO_ERROR)
+					{
+					}
+					break;
+				}
+			}
+		}
+		GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	catch (const std::runtime_error &e)
+	{
+		std::fprintf(stderr, "fractal-uploadbench: %s\n", e.what());
+		return 2;
+	}
+
+	const std::string table = uploadTable(results);
+	std::fputs(table.c_str(), stdout);
+	if (!options.json.empty() && !Bench::write(options.json, Bench::toJson("fractal-uploadbench", results)))
+	{
+		std::fprintf(stderr, "fractal-uploadbench: can't write %s\n", options.json.c_str());
+		return 1;
+	}
+
+	return 0;
+}